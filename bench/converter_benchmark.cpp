@@ -0,0 +1,288 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Benchmarks of every stage of the conversion on a synthetic corpus.
+ *
+ * Every benchmark reports objects/s as items_per_second and the processed
+ * input or output bytes as bytes_per_second. The arguments are the number of
+ * objects and the number of resources per object.
+ *
+ * The validation benchmarks require the schemas, which are passed through the
+ * SDF_LWM2M_BENCH_SDF_SCHEMA and SDF_LWM2M_BENCH_LWM2M_SCHEMA environment
+ * variables, and are skipped otherwise.
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <pugixml.hpp>
+#include <converter.h>
+#include <lwm2m.h>
+#include <lwm2m_stream.h>
+#include <lwm2m_writer.h>
+#include <validator.h>
+#include "main.h"
+#include "corpus.h"
+
+using json = nlohmann::ordered_json;
+
+namespace {
+
+CorpusOptions OptionsFor(const benchmark::State& state)
+{
+    CorpusOptions options;
+    options.objects = static_cast<std::size_t>(state.range(0));
+    options.resources_per_object = static_cast<std::size_t>(state.range(1));
+    return options;
+}
+
+void SetThroughput(benchmark::State& state, std::size_t objects, std::size_t bytes)
+{
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * objects));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+}
+
+void CorpusArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"objects", "resources"});
+    for (int objects : {1, 16, 128}) {
+        for (int resources : {8, 64}) {
+            benchmark->Args({objects, resources});
+        }
+    }
+}
+
+//! Parse the document and every object into owning structs
+void BM_ParseObject(benchmark::State& state)
+{
+    CorpusOptions options = OptionsFor(state);
+    std::string xml = GenerateLwm2mXml(options);
+    for (auto _ : state) {
+        pugi::xml_document document;
+        document.load_buffer(xml.data(), xml.size(), lwm2m::kParseOptions);
+        for (const auto object_node : document.child("LWM2M").children("Object")) {
+            lwm2m::Object object = lwm2m::Object::Parse(object_node);
+            benchmark::DoNotOptimize(object);
+        }
+    }
+    SetThroughput(state, options.objects, xml.size());
+}
+BENCHMARK(BM_ParseObject)->Apply(CorpusArguments);
+
+//! Parse the document in place and every object into views
+void BM_ParseObjectView(benchmark::State& state)
+{
+    CorpusOptions options = OptionsFor(state);
+    std::string xml = GenerateLwm2mXml(options);
+    std::string buffer;
+    for (auto _ : state) {
+        state.PauseTiming();
+        buffer = xml;
+        state.ResumeTiming();
+        pugi::xml_document document;
+        document.load_buffer_inplace(buffer.data(), buffer.size(), lwm2m::kParseOptions);
+        for (const auto object_node : document.child("LWM2M").children("Object")) {
+            lwm2m::ObjectView object = lwm2m::ObjectView::Parse(object_node);
+            benchmark::DoNotOptimize(object);
+        }
+    }
+    SetThroughput(state, options.objects, xml.size());
+}
+BENCHMARK(BM_ParseObjectView)->Apply(CorpusArguments);
+
+//! Write the objects of the DOM based parser as xml, so that they can be compared
+std::string SerializeDocumentObjects(const std::string& xml)
+{
+    std::string output;
+    pugi::xml_document document;
+    document.load_buffer(xml.data(), xml.size(), lwm2m::kParseOptions);
+    {
+        lwm2m::XmlWriter writer(output);
+        for (const auto object_node : document.child("LWM2M").children("Object")) {
+            lwm2m::Object::Parse(object_node).Serialize(writer);
+        }
+    }
+    return output;
+}
+
+//! Write the objects of the streaming parser as xml, so that they can be compared
+std::string SerializeStreamObjects(const std::string& xml)
+{
+    std::string output;
+    std::istringstream stream(xml);
+    {
+        lwm2m::XmlWriter writer(output);
+        lwm2m::ParseObjectStream(stream, [&writer](lwm2m::Object&& object) { object.Serialize(writer); });
+    }
+    return output;
+}
+
+//! Parse every object without building a document
+void BM_ParseObjectStream(benchmark::State& state)
+{
+    CorpusOptions options = OptionsFor(state);
+    std::string xml = GenerateLwm2mXml(options);
+    // The streaming parser has to give the same objects as Object::Parse
+    if (SerializeStreamObjects(xml) != SerializeDocumentObjects(xml)) {
+        state.SkipWithError("The streaming parser and Object::Parse give different objects");
+        return;
+    }
+    for (auto _ : state) {
+        std::istringstream stream(xml);
+        lwm2m::ParseObjectStream(stream, [](lwm2m::Object&& object) { benchmark::DoNotOptimize(object); });
+    }
+    SetThroughput(state, options.objects, xml.size());
+}
+BENCHMARK(BM_ParseObjectStream)->Apply(CorpusArguments);
+
+//! Convert an already parsed document
+void BM_ConvertLwm2mToSdf(benchmark::State& state)
+{
+    CorpusOptions options = OptionsFor(state);
+    std::string xml = GenerateLwm2mXml(options);
+    pugi::xml_document document;
+    document.load_buffer(xml.data(), xml.size(), lwm2m::kParseOptions);
+    for (auto _ : state) {
+        json sdf_model;
+        json sdf_mapping;
+        ConvertLwm2mToSdf(document, sdf_model, sdf_mapping);
+        benchmark::DoNotOptimize(sdf_model);
+    }
+    SetThroughput(state, options.objects, xml.size());
+}
+BENCHMARK(BM_ConvertLwm2mToSdf)->Apply(CorpusArguments);
+
+//! Parse and convert in a single pass
+void BM_ConvertLwm2mToSdfStream(benchmark::State& state)
+{
+    CorpusOptions options = OptionsFor(state);
+    std::string xml = GenerateLwm2mXml(options);
+    for (auto _ : state) {
+        std::istringstream stream(xml);
+        json sdf_model;
+        json sdf_mapping;
+        ConvertLwm2mToSdf(stream, sdf_model, sdf_mapping);
+        benchmark::DoNotOptimize(sdf_model);
+    }
+    SetThroughput(state, options.objects, xml.size());
+}
+BENCHMARK(BM_ConvertLwm2mToSdfStream)->Apply(CorpusArguments);
+
+void BM_ConvertSdfToLwm2m(benchmark::State& state)
+{
+    CorpusOptions options = OptionsFor(state);
+    json sdf_model;
+    json sdf_mapping;
+    GenerateSdf(options, sdf_model, sdf_mapping);
+    std::size_t bytes = sdf_model.dump().size() + sdf_mapping.dump().size();
+    for (auto _ : state) {
+        pugi::xml_document document;
+        ConvertSdfToLwm2m(sdf_model, sdf_mapping, document);
+        benchmark::DoNotOptimize(document);
+    }
+    SetThroughput(state, options.objects, bytes);
+}
+BENCHMARK(BM_ConvertSdfToLwm2m)->Apply(CorpusArguments);
+
+//! Write already converted objects as xml without building a DOM
+void BM_SerializeLwm2m(benchmark::State& state)
+{
+    CorpusOptions options = OptionsFor(state);
+    json sdf_model;
+    json sdf_mapping;
+    GenerateSdf(options, sdf_model, sdf_mapping);
+    std::vector<lwm2m::Object> objects;
+    ConvertSdfToLwm2m(std::as_const(sdf_model), std::as_const(sdf_mapping), objects);
+    std::string xml;
+    for (auto _ : state) {
+        xml.clear();
+        lwm2m::XmlWriter writer(xml);
+        writer.BeginDocument();
+        for (const auto& object : objects) {
+            object.Serialize(writer);
+        }
+        writer.EndDocument();
+        benchmark::DoNotOptimize(xml);
+    }
+    SetThroughput(state, options.objects, xml.size());
+}
+BENCHMARK(BM_SerializeLwm2m)->Apply(CorpusArguments);
+
+void BM_SaveJsonFile(benchmark::State& state)
+{
+    CorpusOptions options = OptionsFor(state);
+    json sdf_model;
+    json sdf_mapping;
+    GenerateSdf(options, sdf_model, sdf_mapping);
+    std::string path = (std::filesystem::temp_directory_path() / "sdf_lwm2m_benchmark.json").string();
+    for (auto _ : state) {
+        SaveJsonFile(path.c_str(), sdf_model);
+    }
+    SetThroughput(state, options.objects, std::filesystem::file_size(path));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_SaveJsonFile)->Apply(CorpusArguments);
+
+void BM_ValidateSdf(benchmark::State& state)
+{
+    const char* schema = std::getenv("SDF_LWM2M_BENCH_SDF_SCHEMA");
+    SdfValidator validator;
+    if (schema == nullptr or validator.LoadSchema(schema) != 0) {
+        state.SkipWithError("SDF_LWM2M_BENCH_SDF_SCHEMA does not point to a sdf schema");
+        return;
+    }
+    CorpusOptions options = OptionsFor(state);
+    json sdf_model;
+    json sdf_mapping;
+    GenerateSdf(options, sdf_model, sdf_mapping);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(validator.Validate(sdf_model));
+    }
+    SetThroughput(state, options.objects, sdf_model.dump().size());
+}
+BENCHMARK(BM_ValidateSdf)->Apply(CorpusArguments);
+
+void BM_ValidateLwm2m(benchmark::State& state)
+{
+    const char* schema = std::getenv("SDF_LWM2M_BENCH_LWM2M_SCHEMA");
+    Lwm2mValidator validator;
+    if (schema == nullptr or validator.LoadSchema(schema) != 0) {
+        state.SkipWithError("SDF_LWM2M_BENCH_LWM2M_SCHEMA does not point to a lwm2m schema");
+        return;
+    }
+    CorpusOptions options = OptionsFor(state);
+    std::string xml = GenerateLwm2mXml(options);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(validator.ValidateMemory(xml.data(), xml.size()));
+    }
+    SetThroughput(state, options.objects, xml.size());
+}
+BENCHMARK(BM_ValidateLwm2m)->Apply(CorpusArguments);
+
+} // namespace
+
+BENCHMARK_MAIN();
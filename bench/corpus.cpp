@@ -0,0 +1,143 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "corpus.h"
+#include <random>
+#include <sstream>
+#include <converter.h>
+#include <lwm2m_stream.h>
+
+using json = nlohmann::ordered_json;
+
+namespace {
+
+const char* const kLwm2mHeader =
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<LWM2M xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+        "xsi:noNamespaceSchemaLocation=\"http://www.openmobilealliance.org/tech/profiles/LWM2M-v1_1.xsd\">\n";
+const char* const kLwm2mFooter = "</LWM2M>\n";
+
+const char* const kWords[] = {
+        "the", "resource", "value", "of", "device", "sensor", "is", "reported", "in", "measured", "current",
+        "minimum", "maximum", "range", "when", "server", "client", "a", "to", "instance", "indicates", "&amp;",
+        "&lt;threshold&gt;", "time", "since", "last", "reset", "configured", "application", "optional",
+};
+
+const char* const kUnits[] = {"Cel", "%RH", "V", "A", "W", "s", "m", "dB", "lx", "Pa"};
+
+struct TypeRange {
+    const char* type;
+    const char* range;
+};
+
+//! Types roughly weighted like the objects of the OMA registry
+const TypeRange kTypes[] = {
+        {"String", ""}, {"String", ""}, {"Integer", "0..255"}, {"Integer", "-40..85"}, {"Integer", ""},
+        {"Float", ""}, {"Float", "-100.0..100.0"}, {"Boolean", ""}, {"Opaque", ""}, {"Time", ""},
+        {"Unsigned Integer", ""}, {"Objlnk", ""}, {"Corelnk", ""},
+};
+
+const char* const kOperations[] = {"R", "R", "R", "RW", "RW", "W", "E"};
+
+template <typename T, std::size_t N>
+const T& Pick(std::mt19937& random, const T (&values)[N])
+{
+    return values[std::uniform_int_distribution<std::size_t>(0, N - 1)(random)];
+}
+
+//! Function used to append a description of roughly the requested length
+void AppendDescription(std::string& xml, std::mt19937& random, std::size_t length)
+{
+    std::size_t start = xml.size();
+    while (xml.size() - start < length) {
+        if (xml.size() != start) {
+            xml.push_back(' ');
+        }
+        xml.append(Pick(random, kWords));
+    }
+    xml.push_back('.');
+}
+
+//! Function used to append a single object, every object has its own random sequence
+void AppendObject(std::string& xml, const CorpusOptions& options, std::size_t object)
+{
+    std::mt19937 random(options.seed * 7919u + static_cast<std::uint32_t>(object));
+    int object_id = options.first_object_id + static_cast<int>(object);
+
+    xml.append("\t<Object ObjectType=\"MODefinition\">\n");
+    xml.append("\t\t<Name>Synthetic Object ").append(std::to_string(object_id)).append("</Name>\n");
+    // Descriptions are partly wrapped in cdata sections like in the registry
+    xml.append("\t\t<Description1><![CDATA[");
+    AppendDescription(xml, random, options.description_length);
+    xml.append("]]></Description1>\n");
+    xml.append("\t\t<ObjectID>").append(std::to_string(object_id)).append("</ObjectID>\n");
+    xml.append("\t\t<ObjectURN>urn:oma:lwm2m:ext:").append(std::to_string(object_id)).append(":1.1</ObjectURN>\n");
+    xml.append("\t\t<LWM2MVersion>1.1</LWM2MVersion>\n");
+    xml.append("\t\t<ObjectVersion>1.1</ObjectVersion>\n");
+    xml.append("\t\t<MultipleInstances>").append(random() % 2 ? "Multiple" : "Single").append("</MultipleInstances>\n");
+    xml.append("\t\t<Mandatory>").append(random() % 4 ? "Optional" : "Mandatory").append("</Mandatory>\n");
+    xml.append("\t\t<Resources>\n");
+    for (std::size_t resource = 0; resource < options.resources_per_object; resource++) {
+        const char* operations = Pick(random, kOperations);
+        bool execute = operations[0] == 'E';
+        const TypeRange& type = Pick(random, kTypes);
+        xml.append("\t\t\t<Item ID=\"").append(std::to_string(resource)).append("\">\n");
+        xml.append("\t\t\t\t<Name>Resource ").append(std::to_string(resource)).append("</Name>\n");
+        xml.append("\t\t\t\t<Operations>").append(operations).append("</Operations>\n");
+        xml.append("\t\t\t\t<MultipleInstances>").append(random() % 5 ? "Single" : "Multiple")
+           .append("</MultipleInstances>\n");
+        xml.append("\t\t\t\t<Mandatory>").append(random() % 3 ? "Optional" : "Mandatory").append("</Mandatory>\n");
+        // Executable resources have neither a type nor a range in the registry
+        xml.append("\t\t\t\t<Type>").append(execute ? "" : type.type).append("</Type>\n");
+        xml.append("\t\t\t\t<RangeEnumeration>").append(execute ? "" : type.range).append("</RangeEnumeration>\n");
+        xml.append("\t\t\t\t<Units>").append(!execute and random() % 3 == 0 ? Pick(random, kUnits) : "")
+           .append("</Units>\n");
+        bool cdata = random() % 4 == 0;
+        xml.append(cdata ? "\t\t\t\t<Description><![CDATA[" : "\t\t\t\t<Description>");
+        AppendDescription(xml, random, options.description_length);
+        xml.append(cdata ? "]]></Description>\n" : "</Description>\n");
+        xml.append("\t\t\t</Item>\n");
+    }
+    xml.append("\t\t</Resources>\n");
+    xml.append("\t\t<Description2></Description2>\n");
+    xml.append("\t</Object>\n");
+}
+
+} // namespace
+
+std::string GenerateLwm2mXml(const CorpusOptions& options)
+{
+    std::string xml = kLwm2mHeader;
+    for (std::size_t object = 0; object < options.objects; object++) {
+        AppendObject(xml, options, object);
+    }
+    xml.append(kLwm2mFooter);
+    return xml;
+}
+
+std::string GenerateLwm2mObjectXml(const CorpusOptions& options, std::size_t object)
+{
+    std::string xml = kLwm2mHeader;
+    AppendObject(xml, options, object);
+    xml.append(kLwm2mFooter);
+    return xml;
+}
+
+int GenerateSdf(const CorpusOptions& options, json& sdf_model_json, json& sdf_mapping_json)
+{
+    std::istringstream lwm2m_stream(GenerateLwm2mXml(options));
+    return ConvertLwm2mToSdf(lwm2m_stream, sdf_model_json, sdf_mapping_json);
+}
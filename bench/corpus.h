@@ -0,0 +1,76 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Generator for synthetic lwm2m object definitions and sdf models used by the benchmarks.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_BENCH_CORPUS_H_
+#define SDF_LWM2M_CONVERTER_BENCH_CORPUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+
+//! Size of the generated corpus
+struct CorpusOptions {
+    //! Number of objects
+    std::size_t objects = 16;
+    //! Number of resources of every object
+    std::size_t resources_per_object = 32;
+    //! Approximate length of every description in characters
+    std::size_t description_length = 128;
+    //! Seed of the random generator, equal options always generate the same corpus
+    std::uint32_t seed = 1;
+    //! ObjectID of the first object, the following objects count upwards
+    int first_object_id = 10000;
+};
+
+//! @brief Generate a lwm2m definition.
+//!
+//! The definition mirrors the structure of the objects of the OMA registry,
+//! resources use every type and operation with a realistic distribution and
+//! some of them have units and ranges.
+//!
+//! @param options The size of the corpus.
+//! @return The xml of a LWM2M element containing every generated object.
+std::string GenerateLwm2mXml(const CorpusOptions& options);
+
+//! @brief Generate a lwm2m definition containing a single object.
+//!
+//! @param options The size of the corpus.
+//! @param object The position of the object inside of the corpus.
+//! @return The xml of a LWM2M element containing the object.
+std::string GenerateLwm2mObjectXml(const CorpusOptions& options, std::size_t object);
+
+//! @brief Generate a matching sdf-model and sdf-mapping.
+//!
+//! The pair is the conversion of the definition generated by GenerateLwm2mXml.
+//!
+//! @param options The size of the corpus.
+//! @param sdf_model_json The generated sdf-model.
+//! @param sdf_mapping_json The generated sdf-mapping.
+//! @return 0 on success, negative on failure.
+int GenerateSdf(const CorpusOptions& options, nlohmann::ordered_json& sdf_model_json,
+                nlohmann::ordered_json& sdf_mapping_json);
+
+#endif //SDF_LWM2M_CONVERTER_BENCH_CORPUS_H_
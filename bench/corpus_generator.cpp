@@ -0,0 +1,116 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <nlohmann/json.hpp>
+#include <argparse/argparse.hpp>
+#include "corpus.h"
+#include "main.h"
+
+using json = nlohmann::ordered_json;
+
+//! Main function
+int main(int argc, char *argv[]) {
+    argparse::ArgumentParser program("sdf-lwm2m-corpus-generator");
+
+    program.add_argument("--objects")
+        .help("Number of generated objects")
+        .default_value(16)
+        .scan<'i', int>();
+
+    program.add_argument("--resources")
+        .help("Number of resources of every object")
+        .default_value(32)
+        .scan<'i', int>();
+
+    program.add_argument("--description-length")
+        .help("Approximate length of every description")
+        .default_value(128)
+        .scan<'i', int>();
+
+    program.add_argument("--seed")
+        .help("Seed of the generator, equal arguments always generate the same corpus")
+        .default_value(1)
+        .scan<'i', int>();
+
+    program.add_argument("--sdf")
+        .help("Also generate the matching sdf-model and sdf-mapping of all objects")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("-o", "-output")
+        .required()
+        .help("Output folder, every object is written into its own Cluster XML");
+
+    try {
+        program.parse_args(argc, argv);
+    }
+    catch (const std::exception &err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    int objects = program.get<int>("--objects");
+    int resources = program.get<int>("--resources");
+    int description_length = program.get<int>("--description-length");
+    if (objects < 0 or resources < 0 or description_length < 0) {
+        std::cerr << "The corpus size has to be positive" << std::endl;
+        std::exit(1);
+    }
+    CorpusOptions options;
+    options.objects = static_cast<std::size_t>(objects);
+    options.resources_per_object = static_cast<std::size_t>(resources);
+    options.description_length = static_cast<std::size_t>(description_length);
+    options.seed = static_cast<std::uint32_t>(program.get<int>("--seed"));
+
+    std::filesystem::path output = program.get<std::string>("-output");
+    std::error_code error_code;
+    std::filesystem::create_directories(output, error_code);
+    if (error_code) {
+        std::cerr << "Failed to create " << output.string() << ": " << error_code.message() << std::endl;
+        std::exit(1);
+    }
+
+    for (std::size_t object = 0; object < options.objects; object++) {
+        std::string filename = std::to_string(options.first_object_id + static_cast<int>(object)) + ".xml";
+        if (SaveTextFile((output / filename).string().c_str(), GenerateLwm2mObjectXml(options, object)) != 0) {
+            std::exit(1);
+        }
+    }
+    std::cout << "Generated " << options.objects << " Cluster XML" << std::endl;
+
+    if (program.get<bool>("--sdf")) {
+        json sdf_model;
+        json sdf_mapping;
+        if (GenerateSdf(options, sdf_model, sdf_mapping) != 0) {
+            std::cerr << "Failed to generate the SDF" << std::endl;
+            std::exit(1);
+        }
+        std::string path_sdf_model;
+        std::string path_sdf_mapping;
+        GenerateSdfFilenames((output / "corpus.json").string(), path_sdf_model, path_sdf_mapping);
+        if (SaveJsonFile(path_sdf_model.c_str(), sdf_model) != 0 or
+            SaveJsonFile(path_sdf_mapping.c_str(), sdf_mapping) != 0) {
+            std::exit(1);
+        }
+        std::cout << "Generated SDF-Model and SDF-Mapping" << std::endl;
+    }
+
+    return 0;
+}
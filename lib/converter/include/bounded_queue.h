@@ -0,0 +1,106 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Queue with a fixed capacity connecting the stages of a pipeline.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_BOUNDED_QUEUE_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_BOUNDED_QUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+//! @brief Queue with a fixed capacity shared by multiple producers and consumers.
+//!
+//! Producers block while the queue is full, so a fast stage cannot run ahead
+//! of a slow one by more than the capacity. Once closed, consumers drain the
+//! remaining items and then stop.
+template <typename T>
+class BoundedQueue {
+public:
+    //! @param capacity Maximum number of queued items, at least one.
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    //! @brief Add an item, blocks while the queue is full.
+    //!
+    //! @param item The item to add.
+    //! @return true if the item was added, false if the queue has been closed.
+    bool Push(T item)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this] { return closed_ or items_.size() < capacity_; });
+            if (closed_) {
+                return false;
+            }
+            items_.push_back(std::move(item));
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    //! @brief Take the oldest item, blocks while the queue is empty.
+    //!
+    //! @param item Receives the item.
+    //! @return true if an item was taken, false if the queue is closed and empty.
+    bool Pop(T& item)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return closed_ or !items_.empty(); });
+            if (items_.empty()) {
+                return false;
+            }
+            item = std::move(items_.front());
+            items_.pop_front();
+        }
+        not_full_.notify_one();
+        return true;
+    }
+
+    //! @brief Stop accepting items and wake every waiting producer and consumer.
+    void Close()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    std::size_t capacity_;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    bool closed_ = false;
+};
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_BOUNDED_QUEUE_H_
@@ -0,0 +1,60 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Hash used to detect changed input files.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_CONTENT_HASH_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_CONTENT_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//! Initial value of HashContent
+constexpr std::uint64_t kContentHashSeed = 14695981039346656037ull;
+
+//! @brief 64 bit FNV-1a hash of a byte range.
+//!
+//! The hash is not cryptographic, it only detects changed content.
+//! Passing the previous hash as seed continues the hash over multiple ranges.
+//!
+//! @param data The bytes to hash.
+//! @param size The number of bytes.
+//! @param hash The hash of the preceding bytes.
+//! @return The hash of the preceding bytes followed by the given ones.
+inline std::uint64_t HashContent(const char* data, std::size_t size, std::uint64_t hash = kContentHashSeed)
+{
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+//! @brief 64 bit FNV-1a hash of a string.
+inline std::uint64_t HashContent(std::string_view text, std::uint64_t hash = kContentHashSeed)
+{
+    return HashContent(text.data(), text.size(), hash);
+}
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_CONTENT_HASH_H_
@@ -28,13 +28,24 @@
 
 #include <nlohmann/json.hpp>
 #include <pugixml.hpp>
+#include <cstddef>
+#include <istream>
 #include <list>
+#include <vector>
+#include "lwm2m.h"
 #include "lwm2m_to_sdf.h"
 #include "sdf_to_lwm2m.h"
 
+//! Version of the generated output, has to be increased whenever the conversion result changes.
+//! Incremental conversions convert every file again once the version differs.
+inline constexpr char kConverterVersion[] = "0.2.0";
+
 //! @brief Convert sdf to lwm2m.
 //!
 //! This function converts a given sdf-model and sdf-mapping into the lwm2m format.
+//! The objects are written as xml and parsed into the document, callers that
+//! only save the result should use the overload for lwm2m objects and a
+//! lwm2m::XmlWriter instead.
 //!
 //! @param sdf_model The input lwm2m definition.
 //! @param sdf_mapping The input sdf-mapping.
@@ -43,9 +54,23 @@
 int ConvertSdfToLwm2m(nlohmann::ordered_json& sdf_model_json, nlohmann::ordered_json& sdf_mapping_json,
                        pugi::xml_document& lwm2m_xml);
 
+//! @brief Convert sdf to lwm2m objects.
+//!
+//! This function converts every sdfObject of the given sdf-model into a lwm2m
+//! object, which can be written by lwm2m::Object::Serialize without building a DOM.
+//!
+//! @param sdf_model_json The input sdf-model.
+//! @param sdf_mapping_json The input sdf-mapping.
+//! @param objects The output lwm2m objects, in the order of the sdf-model.
+//! @return 0 on success, negative on failure.
+int ConvertSdfToLwm2m(const nlohmann::ordered_json& sdf_model_json, const nlohmann::ordered_json& sdf_mapping_json,
+                      std::vector<lwm2m::Object>& objects);
+
 //! @brief Convert lwm2m to sdf.
 //!
-//! This function converts a given sdf-model and sdf-mapping into the lwm2m format.
+//! This function converts every object of the given lwm2m definition into sdf.
+//! The objects are added to the given sdf-model and sdf-mapping, so calling
+//! this function for multiple definitions merges them into one sdf-model.
 //!
 //! @param lwm2m_xml The input lwm2m.
 //! @param sdf_model_json The output sdf-model.
@@ -54,4 +79,47 @@ int ConvertSdfToLwm2m(nlohmann::ordered_json& sdf_model_json, nlohmann::ordered_
 int ConvertLwm2mToSdf(const pugi::xml_document& lwm2m_xml, nlohmann::ordered_json& sdf_model_json,
                       nlohmann::ordered_json& sdf_mapping_json);
 
+//! @brief Convert the objects of a lwm2m bundle to sdf in parallel.
+//!
+//! Every object of the document is parsed and mapped on its own by a pool of
+//! worker threads. The results are merged in document order, so the sdf-model
+//! and sdf-mapping are the same as the ones of the sequential conversion.
+//! Documents with a single object are converted without starting threads.
+//!
+//! @param lwm2m_xml The input lwm2m, which is only read while the workers run.
+//! @param sdf_model_json The output sdf-model.
+//! @param sdf_mapping_json The output sdf-mapping.
+//! @param jobs Number of worker threads, 0 selects the hardware concurrency.
+//! @return 0 on success, negative on failure.
+int ConvertLwm2mToSdf(const pugi::xml_document& lwm2m_xml, nlohmann::ordered_json& sdf_model_json,
+                      nlohmann::ordered_json& sdf_mapping_json, std::size_t jobs);
+
+//! @brief Convert lwm2m to sdf without building a DOM.
+//!
+//! This function parses the lwm2m definition from the given stream in a single
+//! pass and converts every object as soon as it has been read, so only a
+//! single object is kept in memory at a time. The objects are added to the
+//! given sdf-model and sdf-mapping.
+//!
+//! @param lwm2m_stream The input lwm2m.
+//! @param sdf_model_json The output sdf-model.
+//! @param sdf_mapping_json The output sdf-mapping.
+//! @return 0 on success, negative on failure.
+int ConvertLwm2mToSdf(std::istream& lwm2m_stream, nlohmann::ordered_json& sdf_model_json,
+                      nlohmann::ordered_json& sdf_mapping_json);
+
+//! @brief Convert already parsed lwm2m objects to sdf.
+//!
+//! This function converts the given objects in order and takes over their
+//! strings, so every string is moved into the sdf-model or sdf-mapping
+//! instead of being copied. The objects are added to the given sdf-model
+//! and sdf-mapping.
+//!
+//! @param objects The input lwm2m objects, left with empty strings.
+//! @param sdf_model_json The output sdf-model.
+//! @param sdf_mapping_json The output sdf-mapping.
+//! @return 0 on success, negative on failure.
+int ConvertLwm2mToSdf(std::vector<lwm2m::Object>&& objects, nlohmann::ordered_json& sdf_model_json,
+                      nlohmann::ordered_json& sdf_mapping_json);
+
 #endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_CONVERTER_H_
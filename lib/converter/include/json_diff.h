@@ -0,0 +1,90 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Structural comparison of json trees through subtree hashes.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_JSON_DIFF_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_JSON_DIFF_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+//! @brief Hash of every subtree of a json document.
+//!
+//! The hashes are stored in pre-order together with the size of every
+//! subtree, so the hash of a child is found without searching and a whole
+//! subtree is skipped in constant time. The members of an object are hashed
+//! independently of their order, numbers with the same value hash the same
+//! no matter if they are stored as integer or floating point number.
+class JsonMerkleTree {
+public:
+    //! @param json The document, which has to outlive the tree.
+    explicit JsonMerkleTree(const nlohmann::ordered_json& json);
+
+    //! @brief Hash of the whole document.
+    std::uint64_t RootHash() const { return nodes_.front().hash; }
+
+    //! @brief Hash of the node at the given pre-order position.
+    std::uint64_t Hash(std::size_t node) const { return nodes_[node].hash; }
+
+    //! @brief Number of nodes of the subtree at the given pre-order position, including the node itself.
+    std::size_t Size(std::size_t node) const { return nodes_[node].size; }
+
+    const nlohmann::ordered_json& Json() const { return json_; }
+
+private:
+    struct Node {
+        std::uint64_t hash;
+        std::size_t size;
+    };
+
+    std::size_t Build(const nlohmann::ordered_json& value);
+
+    const nlohmann::ordered_json& json_;
+    std::vector<Node> nodes_;
+};
+
+//! Result of a comparison
+struct JsonDiff {
+    //! Json pointers of the differing nodes, at most the requested number
+    std::vector<std::string> paths;
+    //! Number of differing nodes, including the ones that were not listed
+    std::size_t count = 0;
+};
+
+//! @brief Compare two json documents.
+//!
+//! Subtrees with the same hash are skipped, only differing subtrees are
+//! descended. A member that only exists on one side, a changed value or a
+//! changed type is reported with the json pointer of its node.
+//!
+//! @param original The expected document.
+//! @param other The compared document.
+//! @param max_paths Maximum number of listed paths.
+//! @return The differing paths.
+JsonDiff DiffJson(const JsonMerkleTree& original, const JsonMerkleTree& other, std::size_t max_paths = 100);
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_JSON_DIFF_H_
@@ -0,0 +1,94 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Streaming serializer for json documents.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_JSON_WRITER_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_JSON_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+//! @brief Serializes json into a stream while walking the document.
+//!
+//! The output is the same as the one of nlohmann::ordered_json::dump, but
+//! only a fixed size buffer is kept in memory instead of the whole serialized
+//! document. Strings are written as they are, without validating their UTF-8.
+class JsonWriter {
+public:
+    //! Size of the buffer that is collected before it is passed to the stream
+    static constexpr std::size_t kBufferSize = 64 * 1024;
+
+    //! @param stream The stream receiving the serialized json.
+    //! @param indent Number of spaces per level, a negative number writes compact json without any whitespace.
+    explicit JsonWriter(std::ostream& stream, int indent = 4);
+
+    //! @brief Flush the remaining buffer.
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    //! @brief Serialize a json document.
+    void Write(const nlohmann::ordered_json& value);
+
+    //! @brief Pass the buffer to the stream.
+    //!
+    //! @return 0 on success, negative if the stream failed.
+    int Flush();
+
+    //! @brief Number of bytes serialized so far.
+    std::uint64_t BytesWritten() const { return bytes_written_; }
+
+private:
+    void WriteValue(const nlohmann::ordered_json& value, int level);
+    void WriteString(std::string_view value);
+    void WriteNewline(int level);
+
+    void Append(char c)
+    {
+        buffer_.push_back(c);
+        if (buffer_.size() >= kBufferSize) {
+            Flush();
+        }
+    }
+
+    void Append(std::string_view text)
+    {
+        buffer_.append(text);
+        if (buffer_.size() >= kBufferSize) {
+            Flush();
+        }
+    }
+
+    std::ostream& stream_;
+    int indent_;
+    std::string buffer_;
+    std::uint64_t bytes_written_ = 0;
+};
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_JSON_WRITER_H_
@@ -26,20 +26,35 @@
 #ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_H_
 #define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <map>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include <pugixml.hpp>
+#include "range_enumeration.h"
+#include "string_arena.h"
 
 namespace lwm2m {
 
+class XmlWriter;
+
+//! Parse options for lwm2m object definitions.
+//! Only elements, attributes, text and cdata are kept, everything the converter
+//! does not read, like comments or the declaration, is skipped by the parser.
+inline constexpr unsigned int kParseOptions = pugi::parse_cdata | pugi::parse_escapes | pugi::parse_eol;
+
 enum Type {
     String,
     Integer,
+    UnsignedInteger,
     Float,
     Boolean,
     Opaque,
     Time,
     ObjectLink,
+    CoreLink,
     UndefinedType
 };
 
@@ -51,37 +66,157 @@ enum Operations {
     UndefinedOperation
 };
 
-struct Resource {
-    std::string name;
-    Operations operations;
-    bool multiple_instances;
-    bool mandatory;
-    Type type;
-    std::string range_enumeration;
-    std::string units;
-    std::string description;
-
-    static Resource Parse(const pugi::xml_node& resource_node);
-    void Serialize();
+//! @brief Resource of a lwm2m object.
+//!
+//! The string type determines who owns the text of the resource. Resource owns
+//! its strings, ResourceView references strings owned by a StringArena or by
+//! the parsed xml document.
+template <typename StringType>
+struct BasicResource {
+    StringType name;
+    Operations operations = UndefinedOperation;
+    bool multiple_instances = false;
+    bool mandatory = false;
+    Type type = UndefinedType;
+    //! Raw text of the RangeEnumeration, kept to write it back unchanged
+    StringType range_enumeration;
+    //! RangeEnumeration parsed when the text is set
+    RangeEnumeration range;
+    StringType units;
+    StringType description;
+
+    //! @brief Parse a resource item.
+    //!
+    //! For ResourceView the strings reference the document, which has to outlive the resource.
+    static BasicResource Parse(const pugi::xml_node& resource_node);
+
+    //! @brief Write the resource as Item element.
+    //!
+    //! @param id The ID of the resource.
+    //! @param writer The writer receiving the xml.
+    void Serialize(int id, XmlWriter& writer) const;
+
+    //! @brief Set the field that belongs to a child element of the resource item.
+    //!
+    //! Shared by the DOM based and the streaming parser, unknown elements are ignored.
+    //! For ResourceView the value is referenced, not copied.
+    //!
+    //! @param element The name of the child element.
+    //! @param value The text content of the child element.
+    void SetField(std::string_view element, std::string_view value);
+};
+
+typedef BasicResource<std::string> Resource;
+typedef BasicResource<std::string_view> ResourceView;
+
+//! @brief Resources of an object ordered by their ID.
+//!
+//! The resources are stored contiguously and sorted by their ID, so iterating
+//! over them walks a single array. Lookups of IDs below kDenseIdLimit go
+//! through a dense index, higher IDs fall back to a binary search.
+template <typename ResourceType>
+class BasicResourceMap {
+public:
+    typedef std::pair<int, ResourceType> value_type;
+    typedef typename std::vector<value_type>::iterator iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    //! IDs below this limit are looked up through the dense index
+    static constexpr int kDenseIdLimit = 1024;
+
+    iterator begin() { return resources_.begin(); }
+    iterator end() { return resources_.end(); }
+    const_iterator begin() const { return resources_.begin(); }
+    const_iterator end() const { return resources_.end(); }
+
+    std::size_t size() const { return resources_.size(); }
+    bool empty() const { return resources_.empty(); }
+    void reserve(std::size_t capacity) { resources_.reserve(capacity); }
+    void clear();
+
+    //! @brief Find the resource with the given ID.
+    //!
+    //! @return Iterator to the resource, end() if there is none.
+    iterator find(int id);
+    const_iterator find(int id) const;
+
+    //! @brief Check if a resource with the given ID exists.
+    bool contains(int id) const { return find(id) != end(); }
+
+    //! @brief Access the resource with the given ID, a default resource is inserted if there is none.
+    ResourceType& operator[](int id);
+
+private:
+    //! Get the position of the resource with the given ID or the position it has to be inserted at
+    std::size_t LowerBound(int id) const;
+    //! Update the dense index for every resource starting at the given position
+    void Reindex(std::size_t position);
+
+    std::vector<value_type> resources_;
+    //! Position + 1 of the resource for every ID below kDenseIdLimit, 0 if there is none
+    std::vector<std::uint32_t> dense_index_;
 };
 
-struct Object {
-    std::string name;
-    std::string object_type;
-    std::string description_1;
-    std::string description_2;
-    int object_id;
-    std::string object_urn;
-    float lwm2m_version;
-    float object_version;
-    bool multiple_instances;
-    bool mandatory;
-    std::map<int, Resource> resources;
-
-    static Object Parse(const pugi::xml_node& object_node);
-    void Serialize();
+typedef BasicResourceMap<Resource> ResourceMap;
+typedef BasicResourceMap<ResourceView> ResourceViewMap;
+
+//! @brief Lwm2m object definition.
+//!
+//! Object owns its strings, ObjectView references strings owned by a
+//! StringArena or by the parsed xml document, see ParseObjectView.
+template <typename StringType>
+struct BasicObject {
+    StringType name;
+    StringType object_type;
+    StringType description_1;
+    StringType description_2;
+    //! Negative if the ObjectID is not a valid integer
+    int object_id = 0;
+    StringType object_urn;
+    float lwm2m_version = 0;
+    float object_version = 0;
+    bool multiple_instances = false;
+    bool mandatory = false;
+    BasicResourceMap<BasicResource<StringType>> resources;
+
+    //! @brief Parse an object.
+    //!
+    //! For ObjectView the strings reference the document, which has to outlive the object.
+    //! Parsing an in place loaded document therefore does not copy any string.
+    static BasicObject Parse(const pugi::xml_node& object_node);
+
+    //! @brief Write the object as Object element.
+    //!
+    //! The elements are written in the order of the OMA schema, so the
+    //! object only has to be placed between BeginDocument and EndDocument.
+    //!
+    //! @param writer The writer receiving the xml.
+    void Serialize(XmlWriter& writer) const;
+
+    //! @brief Set the field that belongs to a child element of the object.
+    //!
+    //! Shared by the DOM based and the streaming parser, unknown elements and
+    //! the Resources element are ignored. For ObjectView the value is referenced, not copied.
+    //!
+    //! @param element The name of the child element.
+    //! @param value The text content of the child element.
+    void SetField(std::string_view element, std::string_view value);
 };
 
+typedef BasicObject<std::string> Object;
+typedef BasicObject<std::string_view> ObjectView;
+
+//! @brief Parse an object into strings owned by an arena.
+//!
+//! Every string is stored inside of the arena, short strings like names,
+//! units and ranges are interned, so the object stays valid after the
+//! document is gone until the arena gets cleared.
+//!
+//! @param object_node The object node.
+//! @param arena The arena owning the strings.
+//! @return The parsed object.
+ObjectView ParseObjectView(const pugi::xml_node& object_node, StringArena& arena);
+
 }
 
 #endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_H_
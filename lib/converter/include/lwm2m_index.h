@@ -0,0 +1,121 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Persistent binary index of the parsed objects of a lwm2m registry.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_INDEX_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "lwm2m.h"
+#include "mapped_file.h"
+
+namespace lwm2m {
+
+//! @brief Binary image of every object of a registry directory.
+//!
+//! The image is created once from the object xml of a directory and memory
+//! mapped on later runs, so looking up objects does not parse any xml.
+//! Every file of the directory is recorded with its modification time, size
+//! and content hash. Updating the index only reparses the files whose content
+//! changed and keeps the entries of every other file.
+//!
+//! The image uses the native byte order and is rejected on mismatch, as well
+//! as on any other format version.
+class ObjectIndex {
+public:
+    //! Version of the binary format, images with another version are rebuilt
+    static constexpr std::uint32_t kFormatVersion = 1;
+
+    ObjectIndex() = default;
+    ObjectIndex(const ObjectIndex&) = delete;
+    ObjectIndex& operator=(const ObjectIndex&) = delete;
+
+    //! @brief Map an existing index image.
+    //!
+    //! @param path The path to the index image.
+    //! @return 0 on success, negative if the image is missing, truncated or has an incompatible format.
+    int Open(const char* path);
+
+    //! @brief Bring the index image in sync with a registry directory and map it.
+    //!
+    //! Files with an unchanged modification time and size are taken over without
+    //! reading them, files with a changed modification time are hashed and only
+    //! reparsed if their content changed. The image is only rewritten if
+    //! something changed, the new image replaces the old one atomically.
+    //!
+    //! @param directory The directory containing the object xml.
+    //! @param path The path to the index image.
+    //! @return 0 on success, negative on failure.
+    int Update(const std::string& directory, const char* path);
+
+    //! @brief Remove the mapping of the image.
+    void Close();
+
+    //! @brief Number of indexed objects.
+    std::size_t Size() const;
+
+    //! @brief Get an indexed object.
+    //!
+    //! The strings of the returned view reference the mapped image and are
+    //! valid until the index is closed or updated.
+    //!
+    //! @param position Position of the object, less than Size().
+    //! @return View of the object.
+    ObjectView Get(std::size_t position) const;
+
+    //! @brief Find the most recent version of an object.
+    //!
+    //! @param object_id The ObjectID.
+    //! @param object The found object.
+    //! @return 0 on success, negative if there is no such object.
+    int Find(int object_id, ObjectView& object) const;
+
+    //! @brief Find a specific version of an object.
+    //!
+    //! @param object_id The ObjectID.
+    //! @param object_version The ObjectVersion.
+    //! @param object The found object.
+    //! @return 0 on success, negative if there is no such object.
+    int Find(int object_id, float object_version, ObjectView& object) const;
+
+    //! @brief Find an object by its ObjectURN.
+    //!
+    //! @param object_urn The ObjectURN.
+    //! @param object The found object.
+    //! @return 0 on success, negative if there is no such object.
+    int FindByUrn(std::string_view object_urn, ObjectView& object) const;
+
+private:
+    //! Check that every record and string of the mapped image lies inside of it
+    int Verify() const;
+
+    MappedFile image_;
+};
+
+}
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_INDEX_H_
@@ -0,0 +1,53 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Streaming parser which fills lwm2m objects without building a DOM.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_STREAM_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_STREAM_H_
+
+#include <functional>
+#include <istream>
+#include "lwm2m.h"
+
+namespace lwm2m {
+
+//! Function receiving every object found by the streaming parser
+typedef std::function<void(Object&& object)> ObjectCallback;
+
+//! @brief Parse lwm2m objects from a stream without building a DOM.
+//!
+//! The stream is read once from beginning to end. Every Object element below
+//! the LWM2M root element is filled directly from the stream and handed to the
+//! callback as soon as its end tag has been read, so only a single object is
+//! kept in memory at a time. The result for every object is the same as the
+//! one of the DOM based Object::Parse, which stays the reference implementation.
+//!
+//! @param input The input stream containing the xml.
+//! @param callback The function receiving the parsed objects.
+//! @return 0 on success, negative on failure.
+int ParseObjectStream(std::istream& input, const ObjectCallback& callback);
+
+}
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_STREAM_H_
@@ -1,8 +1,71 @@
-//
-// Created by Niklas on 07.11.2024.
-//
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Functions to map parsed lwm2m objects onto sdf.
+ */
 
 #ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_TO_SDF_H_
 #define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_TO_SDF_H_
 
+#include <nlohmann/json.hpp>
+#include "lwm2m.h"
+
+//! @brief Map a lwm2m object onto sdf.
+//!
+//! This function adds the given object as a sdfObject to the sdf-model and
+//! stores the lwm2m specific information inside the sdf-mapping.
+//! Existing sdfObjects of the sdf-model are kept, which allows multiple
+//! objects to be mapped into the same sdf-model.
+//!
+//! @param object The input lwm2m object.
+//! @param sdf_model_json The output sdf-model.
+//! @param sdf_mapping_json The output sdf-mapping.
+//! @return 0 on success, negative on failure.
+int MapLwm2mObject(const lwm2m::Object& object, nlohmann::ordered_json& sdf_model_json,
+                   nlohmann::ordered_json& sdf_mapping_json);
+
+//! @brief Map a lwm2m object view onto sdf.
+//!
+//! Same as the overload for owning objects, the strings of the view are only
+//! copied into the resulting json.
+//!
+//! @param object The input lwm2m object view.
+//! @param sdf_model_json The output sdf-model.
+//! @param sdf_mapping_json The output sdf-mapping.
+//! @return 0 on success, negative on failure.
+int MapLwm2mObject(const lwm2m::ObjectView& object, nlohmann::ordered_json& sdf_model_json,
+                   nlohmann::ordered_json& sdf_mapping_json);
+
+//! @brief Map a lwm2m object onto sdf while taking over its strings.
+//!
+//! Same as the overload for owning objects, but the strings of the object are
+//! moved into the resulting json instead of being copied. The object is left
+//! with empty strings.
+//!
+//! @param object The input lwm2m object.
+//! @param sdf_model_json The output sdf-model.
+//! @param sdf_mapping_json The output sdf-mapping.
+//! @return 0 on success, negative on failure.
+int MapLwm2mObject(lwm2m::Object&& object, nlohmann::ordered_json& sdf_model_json,
+                   nlohmann::ordered_json& sdf_mapping_json);
+
 #endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_TO_SDF_H_
@@ -0,0 +1,328 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Compile time tables to decode and encode the enum-like values of lwm2m and
+ * to map them onto sdf.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_TOKENS_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_TOKENS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include "lwm2m.h"
+
+namespace lwm2m {
+
+//! Text representation of a value inside of the xml
+template <typename Value>
+struct Token {
+    std::string_view text;
+    Value value;
+};
+
+//! @brief Seeded FNV-1a hash used for the token tables.
+constexpr std::uint32_t HashToken(std::string_view text, std::uint32_t seed)
+{
+    std::uint32_t hash = 2166136261u ^ seed;
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//! @brief Lookup table with a perfect hash that is generated at compile time.
+//!
+//! The constructor searches for a hash seed that maps every token onto its own
+//! slot. Decoding hashes the text once and compares it against a single
+//! candidate, without allocating. Unknown text decodes to the undefined value.
+template <typename Value, std::size_t N>
+class TokenTable {
+public:
+    //! Number of slots, a power of two with at least four slots per token keeps the seed search short
+    static constexpr std::size_t kSlots = [] {
+        std::size_t slots = 1;
+        while (slots < 4 * N) {
+            slots *= 2;
+        }
+        return slots;
+    }();
+    static constexpr std::uint32_t kMaxSeed = 4096;
+
+    constexpr TokenTable(const Token<Value> (&tokens)[N], Value undefined) : undefined_(undefined)
+    {
+        for (std::size_t i = 0; i < N; i++) {
+            tokens_[i] = tokens[i];
+        }
+        for (seed_ = 0; seed_ < kMaxSeed; seed_++) {
+            if (TryBuild()) {
+                break;
+            }
+        }
+    }
+
+    //! @brief Check if a seed without collisions was found.
+    constexpr bool IsPerfect() const { return seed_ < kMaxSeed; }
+
+    //! @brief Decode the text of a token.
+    constexpr Value Decode(std::string_view text) const
+    {
+        std::uint8_t slot = slots_[HashToken(text, seed_) & (kSlots - 1)];
+        if (slot != 0 and tokens_[slot - 1].text == text) {
+            return tokens_[slot - 1].value;
+        }
+        return undefined_;
+    }
+
+    //! @brief Encode a value as the text of its first token, empty if there is none.
+    constexpr std::string_view Encode(Value value) const
+    {
+        for (const auto& token : tokens_) {
+            if (token.value == value) {
+                return token.text;
+            }
+        }
+        return {};
+    }
+
+private:
+    constexpr bool TryBuild()
+    {
+        for (auto& slot : slots_) {
+            slot = 0;
+        }
+        for (std::size_t i = 0; i < N; i++) {
+            std::size_t index = HashToken(tokens_[i].text, seed_) & (kSlots - 1);
+            if (slots_[index] != 0) {
+                return false;
+            }
+            slots_[index] = static_cast<std::uint8_t>(i + 1);
+        }
+        return true;
+    }
+
+    std::array<Token<Value>, N> tokens_{};
+    std::array<std::uint8_t, kSlots> slots_{};
+    Value undefined_;
+    std::uint32_t seed_ = 0;
+};
+
+//! Child elements of a resource item
+enum class ResourceField {
+    Name,
+    Operations,
+    MultipleInstances,
+    Mandatory,
+    Type,
+    RangeEnumeration,
+    Units,
+    Description,
+    Unknown
+};
+
+//! Child elements of an object
+enum class ObjectField {
+    Name,
+    Description1,
+    Description2,
+    ObjectID,
+    ObjectURN,
+    LWM2MVersion,
+    ObjectVersion,
+    MultipleInstances,
+    Mandatory,
+    Unknown
+};
+
+inline constexpr Token<ResourceField> kResourceFieldTokens[] = {
+    {"Name", ResourceField::Name},
+    {"Operations", ResourceField::Operations},
+    {"MultipleInstances", ResourceField::MultipleInstances},
+    {"Mandatory", ResourceField::Mandatory},
+    {"Type", ResourceField::Type},
+    {"RangeEnumeration", ResourceField::RangeEnumeration},
+    {"Units", ResourceField::Units},
+    {"Description", ResourceField::Description},
+};
+
+inline constexpr Token<ObjectField> kObjectFieldTokens[] = {
+    {"Name", ObjectField::Name},
+    {"Description1", ObjectField::Description1},
+    {"Description2", ObjectField::Description2},
+    {"ObjectID", ObjectField::ObjectID},
+    {"ObjectURN", ObjectField::ObjectURN},
+    {"LWM2MVersion", ObjectField::LWM2MVersion},
+    {"ObjectVersion", ObjectField::ObjectVersion},
+    {"MultipleInstances", ObjectField::MultipleInstances},
+    {"Mandatory", ObjectField::Mandatory},
+};
+
+inline constexpr Token<Type> kTypeTokens[] = {
+    {"String", String},
+    {"Integer", Integer},
+    {"Unsigned Integer", UnsignedInteger},
+    {"Float", Float},
+    {"Boolean", Boolean},
+    {"Opaque", Opaque},
+    {"Time", Time},
+    {"Objlnk", ObjectLink},
+    {"Corelnk", CoreLink},
+};
+
+inline constexpr Token<Operations> kOperationsTokens[] = {
+    {"R", Read},
+    {"W", Write},
+    {"RW", ReadWrite},
+    {"E", Execute},
+};
+
+//! Everything except "Single" is treated as multiple instances
+inline constexpr Token<bool> kMultipleInstancesTokens[] = {
+    {"Single", false},
+    {"Multiple", true},
+};
+
+//! Everything except "Optional" is treated as mandatory
+inline constexpr Token<bool> kMandatoryTokens[] = {
+    {"Optional", false},
+    {"Mandatory", true},
+};
+
+inline constexpr TokenTable kResourceFieldTable(kResourceFieldTokens, ResourceField::Unknown);
+inline constexpr TokenTable kObjectFieldTable(kObjectFieldTokens, ObjectField::Unknown);
+inline constexpr TokenTable kTypeTable(kTypeTokens, UndefinedType);
+inline constexpr TokenTable kOperationsTable(kOperationsTokens, UndefinedOperation);
+inline constexpr TokenTable kMultipleInstancesTable(kMultipleInstancesTokens, true);
+inline constexpr TokenTable kMandatoryTable(kMandatoryTokens, true);
+
+static_assert(kResourceFieldTable.IsPerfect() and kObjectFieldTable.IsPerfect() and kTypeTable.IsPerfect() and
+              kOperationsTable.IsPerfect() and kMultipleInstancesTable.IsPerfect() and kMandatoryTable.IsPerfect(),
+              "No perfect hash found for a token table");
+static_assert(kTypeTable.Decode("Objlnk") == ObjectLink and kTypeTable.Decode("Objlink") == UndefinedType);
+static_assert(kOperationsTable.Decode("RW") == ReadWrite and kOperationsTable.Decode("") == UndefinedOperation);
+
+//! Representation of a lwm2m type in sdf
+struct SdfType {
+    std::string_view type;
+    std::string_view sdf_type;
+    //! The value range starts at zero
+    bool unsigned_integer;
+};
+
+//! Representation of lwm2m operations in sdf
+struct SdfOperations {
+    //! Mapped onto a sdfAction instead of a sdfProperty
+    bool action;
+    bool readable;
+    bool writable;
+};
+
+//! Mapping of lwm2m types onto sdf, indexed by Type
+inline constexpr SdfType kSdfTypes[] = {
+    {"string", "", false},             // String
+    {"integer", "", false},            // Integer
+    {"integer", "", true},             // UnsignedInteger
+    {"number", "", false},             // Float
+    {"boolean", "", false},            // Boolean
+    {"string", "byte-string", false},  // Opaque
+    {"integer", "unix-time", false},   // Time
+    {"string", "", false},             // ObjectLink
+    {"string", "", false},             // CoreLink
+    {"", "", false},                   // UndefinedType
+};
+static_assert(std::size(kSdfTypes) == UndefinedType + 1, "Every Type needs a sdf mapping");
+
+//! Mapping of lwm2m operations onto sdf, indexed by Operations
+inline constexpr SdfOperations kSdfOperations[] = {
+    {false, true, false},   // Read
+    {false, false, true},   // Write
+    {false, true, true},    // ReadWrite
+    {true, false, false},   // Execute
+    {false, false, false},  // UndefinedOperation
+};
+static_assert(std::size(kSdfOperations) == UndefinedOperation + 1, "Every Operations value needs a sdf mapping");
+
+//! @brief Decode the Type element of a resource.
+constexpr Type DecodeType(std::string_view text) { return kTypeTable.Decode(text); }
+
+//! @brief Encode a Type as it is written inside of the xml.
+constexpr std::string_view EncodeType(Type type) { return kTypeTable.Encode(type); }
+
+//! @brief Decode the Operations element of a resource.
+constexpr Operations DecodeOperations(std::string_view text) { return kOperationsTable.Decode(text); }
+
+//! @brief Encode Operations as they are written inside of the xml.
+constexpr std::string_view EncodeOperations(Operations operations) { return kOperationsTable.Encode(operations); }
+
+//! @brief Decode the MultipleInstances element of an object or resource.
+constexpr bool DecodeMultipleInstances(std::string_view text) { return kMultipleInstancesTable.Decode(text); }
+
+//! @brief Decode the Mandatory element of an object or resource.
+constexpr bool DecodeMandatory(std::string_view text) { return kMandatoryTable.Decode(text); }
+
+//! @brief Get the sdf representation of a Type.
+constexpr const SdfType& MapTypeToSdf(Type type) { return kSdfTypes[type]; }
+
+//! @brief Get the lwm2m type of sdf data qualities.
+//!
+//! Several types share a sdf representation, the first one of Type is used.
+//!
+//! @param type The type quality.
+//! @param sdf_type The sdfType quality, empty if there is none.
+//! @param unsigned_integer The value range starts at zero.
+//! @return The matching type, UndefinedType if there is none.
+constexpr Type MapSdfToType(std::string_view type, std::string_view sdf_type, bool unsigned_integer)
+{
+    for (std::size_t i = 0; i < UndefinedType; i++) {
+        const SdfType& sdf = kSdfTypes[i];
+        if (sdf.type == type and sdf.sdf_type == sdf_type and sdf.unsigned_integer == unsigned_integer) {
+            return static_cast<Type>(i);
+        }
+    }
+    return UndefinedType;
+}
+
+//! @brief Get the lwm2m operations of a sdf affordance.
+constexpr Operations MapSdfToOperations(bool action, bool readable, bool writable)
+{
+    for (std::size_t i = 0; i < UndefinedOperation; i++) {
+        const SdfOperations& sdf = kSdfOperations[i];
+        if (sdf.action == action and (action or (sdf.readable == readable and sdf.writable == writable))) {
+            return static_cast<Operations>(i);
+        }
+    }
+    return UndefinedOperation;
+}
+
+static_assert(MapSdfToType("integer", "unix-time", false) == Time and MapSdfToType("string", "", false) == String);
+static_assert(MapSdfToOperations(false, true, true) == ReadWrite and MapSdfToOperations(true, false, false) == Execute);
+
+//! @brief Get the sdf representation of Operations.
+constexpr const SdfOperations& MapOperationsToSdf(Operations operations) { return kSdfOperations[operations]; }
+
+}
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_TOKENS_H_
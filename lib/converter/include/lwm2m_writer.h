@@ -0,0 +1,104 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Buffered writer for lwm2m object definitions.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_WRITER_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace lwm2m {
+
+//! @brief Writes lwm2m xml without building a DOM.
+//!
+//! The writer produces the layout of the OMA registry, every element on its
+//! own line and indented by tabs. Text and attribute values are escaped.
+//! Objects are written through BasicObject::Serialize between BeginDocument
+//! and EndDocument.
+//!
+//! Written xml is either appended to a string or collected in a fixed size
+//! buffer that is passed to a stream once it is full.
+class XmlWriter {
+public:
+    //! Size of the buffer that is collected before it is passed to the stream
+    static constexpr std::size_t kBufferSize = 64 * 1024;
+
+    //! @param stream The stream receiving the xml.
+    explicit XmlWriter(std::ostream& stream);
+
+    //! @param output The string the xml gets appended to.
+    explicit XmlWriter(std::string& output);
+
+    //! @brief Flush the remaining buffer.
+    ~XmlWriter();
+
+    XmlWriter(const XmlWriter&) = delete;
+    XmlWriter& operator=(const XmlWriter&) = delete;
+
+    //! @brief Write the xml declaration and open the LWM2M element.
+    void BeginDocument();
+
+    //! @brief Close the LWM2M element.
+    void EndDocument();
+
+    //! @brief Write an opening tag on its own line.
+    void OpenElement(int depth, std::string_view name);
+
+    //! @brief Write an opening tag with a single attribute on its own line.
+    void OpenElement(int depth, std::string_view name, std::string_view attribute, std::string_view value);
+
+    //! @brief Write a closing tag on its own line.
+    void CloseElement(int depth, std::string_view name);
+
+    //! @brief Write an element that only contains text on its own line.
+    void TextElement(int depth, std::string_view name, std::string_view text);
+
+    //! @brief Pass the buffer to the stream.
+    //!
+    //! @return 0 on success, negative if the stream failed.
+    int Flush();
+
+    //! @brief Number of bytes written so far.
+    std::uint64_t BytesWritten() const;
+
+private:
+    void Indent(int depth) { output_->append(static_cast<std::size_t>(depth), '\t'); }
+    void WriteEscaped(std::string_view text);
+    void EndLine();
+
+    std::ostream* stream_ = nullptr;
+    std::string buffer_;
+    //! Either the buffer or the string given by the caller
+    std::string* output_;
+    //! Bytes passed to the stream, or the size of the string before anything was written
+    std::uint64_t bytes_written_ = 0;
+};
+
+}
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_LWM2M_WRITER_H_
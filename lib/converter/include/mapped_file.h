@@ -0,0 +1,75 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Read-only and copy-on-write memory mappings of files.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_MAPPED_FILE_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_MAPPED_FILE_H_
+
+#include <cstddef>
+
+//! @brief Memory mapping of a whole file.
+//!
+//! The mapping shares its pages with the page cache of the operating system.
+//! A copy-on-write mapping can be modified in place, only the modified pages
+//! get copied and the file itself is never changed.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    //! @brief Map a file into memory.
+    //!
+    //! @param path The path to the file.
+    //! @param copy_on_write Map the file writable without writing changes back to the file.
+    //! @return 0 on success, negative on failure.
+    int Open(const char* path, bool copy_on_write = false);
+
+    //! @brief Remove the mapping.
+    void Close();
+
+    //! @brief Read every page of the mapping.
+    //!
+    //! The content is in memory afterwards, so a later reader of the mapping
+    //! does not wait for the disk. Used to load files ahead of their use.
+    void Prefetch() const;
+
+    char* Data() { return data_; }
+    const char* Data() const { return data_; }
+    std::size_t Size() const { return size_; }
+
+private:
+    char* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_MAPPED_FILE_H_
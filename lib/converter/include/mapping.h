@@ -1,8 +1,65 @@
-//
-// Created by Niklas on 07.11.2024.
-//
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Helpers shared by both conversion directions to address entries of the sdf-mapping.
+ */
 
 #ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_MAPPING_H_
 #define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_MAPPING_H_
 
+#include <string>
+#include <string_view>
+
+//! Namespace used for the generated sdf-model and sdf-mapping
+inline constexpr char kLwm2mNamespacePrefix[] = "lwm2m";
+inline constexpr char kLwm2mNamespace[] = "https://onedm.org/ecosystem/lwm2m";
+
+//! @brief Append a name as an escaped json pointer token.
+//!
+//! @param name The name of a sdf definition.
+//! @param pointer The escaped token is appended to this pointer.
+inline void AppendPointerToken(std::string_view name, std::string& pointer)
+{
+    for (char c : name) {
+        if (c == '~') {
+            pointer.append("~0");
+        } else if (c == '/') {
+            pointer.append("~1");
+        } else {
+            pointer.push_back(c);
+        }
+    }
+}
+
+//! @brief Escape a name so that it can be used as a json pointer token.
+//!
+//! @param name The name of a sdf definition.
+//! @return The escaped token.
+inline std::string EscapePointerToken(std::string_view name)
+{
+    std::string token;
+    token.reserve(name.size());
+    AppendPointerToken(name, token);
+    return token;
+}
+
 #endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_MAPPING_H_
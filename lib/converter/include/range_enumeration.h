@@ -0,0 +1,87 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Parsed representation of the RangeEnumeration of a lwm2m resource and
+ * checked parsing and formatting of the numbers inside of the xml.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_RANGE_ENUMERATION_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_RANGE_ENUMERATION_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lwm2m {
+
+enum class RangeKind {
+    //! The resource has no RangeEnumeration
+    None,
+    //! Closed interval between minimum and maximum, the length of the value for strings
+    Range,
+    //! Set of the allowed values
+    Enumeration,
+    //! The text could not be parsed
+    Invalid
+};
+
+//! @brief RangeEnumeration of a resource, parsed once when the resource is loaded.
+//!
+//! Ranges are written as "0..100" or "-40-85", enumerations as "1,2,5".
+//! Whether a range limits the value or the length of the value depends on the
+//! type of the resource, so it is only decided by the consumer.
+struct RangeEnumeration {
+    RangeKind kind = RangeKind::None;
+    double minimum = 0;
+    double maximum = 0;
+    std::vector<double> values;
+};
+
+//! @brief Parse the text of a RangeEnumeration element.
+//!
+//! @param text The text of the element.
+//! @return The parsed range or enumeration, RangeKind::Invalid if the text is not understood.
+RangeEnumeration ParseRangeEnumeration(std::string_view text);
+
+//! @brief Parse an integer, surrounding whitespace is ignored.
+//!
+//! @param text The text of the number.
+//! @param value Receives the number, unchanged on failure.
+//! @return 0 on success, negative if the text is not an integer.
+int ParseInteger(std::string_view text, int& value);
+
+//! @brief Parse a floating point number, surrounding whitespace is ignored.
+//!
+//! @param text The text of the number.
+//! @param value Receives the number, unchanged on failure.
+//! @return 0 on success, negative if the text is not a number.
+int ParseFloat(std::string_view text, float& value);
+
+//! @brief Format a version like the registry does, with at least one decimal.
+//!
+//! @param version The version, e.g. LWM2MVersion or ObjectVersion.
+//! @return The text of the version, e.g. "1.0" or "1.1".
+std::string FormatVersion(float version);
+
+}
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_RANGE_ENUMERATION_H_
@@ -1,8 +1,53 @@
-//
-// Created by Niklas on 07.11.2024.
-//
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Functions to map sdf onto lwm2m objects.
+ */
 
 #ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_SDF_TO_LWM2M_H_
 #define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_SDF_TO_LWM2M_H_
 
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "lwm2m.h"
+
+//! @brief Map the sdfObjects of a sdf-model onto lwm2m objects.
+//!
+//! Every sdfObject becomes an object, every sdfProperty and sdfAction a
+//! resource. The lwm2m specific information is taken from the entry of the
+//! definition inside the sdf-mapping. Definitions without an entry get the
+//! information that can be derived from sdf, resources without an ID get the
+//! next free ID of their object. Objects without an ID cannot be mapped.
+//! The sdf-mapping entries are indexed by their json pointer once, so looking
+//! up the entry of a definition does not depend on the size of the sdf-mapping.
+//! Definitions with a sdfRef are mapped with the referenced definition patched
+//! by their own qualities. Every reference is resolved once per sdf-model,
+//! references that cannot be resolved or form a cycle are reported and ignored.
+//!
+//! @param sdf_model_json The input sdf-model.
+//! @param sdf_mapping_json The input sdf-mapping.
+//! @param objects The resulting objects are appended in the order of the sdf-model.
+//! @return 0 on success, negative on failure.
+int MapSdfModel(const nlohmann::ordered_json& sdf_model_json, const nlohmann::ordered_json& sdf_mapping_json,
+                std::vector<lwm2m::Object>& objects);
+
 #endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_SDF_TO_LWM2M_H_
@@ -0,0 +1,82 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Arena which owns the strings of parsed lwm2m objects.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_STRING_ARENA_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_STRING_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+//! @brief Block based storage for strings with interning.
+//!
+//! Strings are copied into large blocks instead of separate heap allocations
+//! and stay valid until the arena is cleared or destroyed, which releases every
+//! block at once. The arena is not thread safe, every batch or worker is
+//! expected to use its own arena.
+class StringArena {
+public:
+    //! Strings up to this size are interned by Store
+    static constexpr std::size_t kInternLimit = 64;
+
+    //! @param block_size Size of the blocks the strings are copied into.
+    explicit StringArena(std::size_t block_size = 64 * 1024) : block_size_(block_size) {}
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    //! @brief Copy a string into the arena.
+    std::string_view Copy(std::string_view value);
+
+    //! @brief Copy a string into the arena once, equal strings share the same storage.
+    std::string_view Intern(std::string_view value);
+
+    //! @brief Intern short strings and copy long ones.
+    //!
+    //! Short strings like names, units or ranges repeat a lot across objects,
+    //! while long descriptions are almost always unique.
+    std::string_view Store(std::string_view value)
+    {
+        return value.size() <= kInternLimit ? Intern(value) : Copy(value);
+    }
+
+    //! @brief Release every string of the arena at once.
+    void Clear();
+
+    //! @brief Number of bytes of string data held by the arena.
+    std::size_t BytesUsed() const { return bytes_used_; }
+
+private:
+    std::size_t block_size_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* current_ = nullptr;
+    std::size_t remaining_ = 0;
+    std::size_t bytes_used_ = 0;
+    std::unordered_set<std::string_view> interned_;
+};
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_STRING_ARENA_H_
@@ -0,0 +1,77 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Fixed size worker pool used to spread conversions across multiple cores.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_THREAD_POOL_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+//! @brief Fixed size pool of worker threads.
+//!
+//! Tasks are executed in submission order by the first free worker.
+//! Tasks must not throw, exceptions have to be handled inside the task.
+class ThreadPool {
+public:
+    //! @brief Start the worker threads.
+    //!
+    //! @param thread_count Number of workers, 0 selects the hardware concurrency.
+    explicit ThreadPool(std::size_t thread_count);
+
+    //! @brief Wait for all pending tasks and join the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //! @brief Queue a task for execution.
+    //!
+    //! @param task The task to execute.
+    void Submit(std::function<void()> task);
+
+    //! @brief Block until every submitted task has finished.
+    void Wait();
+
+    //! @brief Number of worker threads.
+    std::size_t Size() const { return workers_.size(); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable task_available_;
+    std::condition_variable tasks_done_;
+    std::size_t active_tasks_ = 0;
+    bool stopping_ = false;
+};
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_THREAD_POOL_H_
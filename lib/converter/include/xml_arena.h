@@ -0,0 +1,117 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Arena allocator for the memory pages of pugixml documents.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_XML_ARENA_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_XML_ARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//! @brief Bump allocator serving the allocations of pugixml documents.
+//!
+//! Freeing memory does nothing, the whole arena is reset in bulk once every
+//! document using it is gone. The chunks are kept for reuse, so a worker that
+//! parses one document after another stops allocating from the global heap
+//! after the first few documents.
+//!
+//! An arena is used by a single thread at a time, documents may be destroyed
+//! on any thread.
+class XmlArena {
+public:
+    //! Size of the chunks allocations are served from
+    static constexpr std::size_t kChunkSize = 256 * 1024;
+
+    XmlArena() = default;
+    ~XmlArena() = default;
+
+    XmlArena(const XmlArena&) = delete;
+    XmlArena& operator=(const XmlArena&) = delete;
+
+    //! @brief Allocate memory aligned like malloc.
+    //!
+    //! Allocations larger than a quarter of a chunk get a block of their own.
+    //!
+    //! @param size Number of bytes.
+    //! @return The memory, nullptr if the allocation failed.
+    void* Allocate(std::size_t size);
+
+    //! @brief Make the memory of the arena available again.
+    //!
+    //! Nothing happens while memory of the arena is still in use, so a
+    //! document that outlives its scope keeps working.
+    //!
+    //! @return 0 on success, negative if memory of the arena is still in use.
+    int Reset();
+
+    //! @brief Number of bytes reserved from the global heap.
+    std::size_t BytesReserved() const;
+
+private:
+    friend void XmlArenaDeallocate(void* memory);
+
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    std::vector<std::unique_ptr<char[]>> large_blocks_;
+    std::size_t large_bytes_ = 0;
+    std::size_t current_chunk_ = 0;
+    std::size_t chunk_used_ = 0;
+    std::atomic<std::size_t> live_allocations_{0};
+};
+
+//! @brief Route every allocation of pugixml through the arena of the current thread.
+//!
+//! Threads without an active arena allocate from the global heap. Has to be
+//! called before the first document is created, calling it again does nothing.
+void InstallXmlArena();
+
+//! @brief Allocation function installed by InstallXmlArena.
+void* XmlArenaAllocate(std::size_t size);
+
+//! @brief Deallocation function installed by InstallXmlArena.
+void XmlArenaDeallocate(void* memory);
+
+//! @brief Get the arena of the calling thread.
+XmlArena& ThreadXmlArena();
+
+//! @brief Activates an arena for the calling thread until the scope ends.
+//!
+//! Documents created inside the scope allocate from the arena, which is reset
+//! at the end of the scope. Documents therefore have to be declared after the
+//! scope, so they are destroyed before it. Scopes can be nested.
+class XmlArenaScope {
+public:
+    explicit XmlArenaScope(XmlArena& arena);
+    ~XmlArenaScope();
+
+    XmlArenaScope(const XmlArenaScope&) = delete;
+    XmlArenaScope& operator=(const XmlArenaScope&) = delete;
+
+private:
+    XmlArena& arena_;
+    XmlArena* previous_;
+};
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_XML_ARENA_H_
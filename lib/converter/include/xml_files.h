@@ -0,0 +1,42 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Discovery of the object xml files of a registry directory.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_XML_FILES_H_
+#define SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_XML_FILES_H_
+
+#include <filesystem>
+#include <vector>
+
+//! @brief Collect every xml file below a directory.
+//!
+//! The directory is searched recursively for regular files with the .xml
+//! extension. The files are ordered by their generic path relative to the
+//! directory, so the order does not depend on the file system.
+//!
+//! @param directory The directory to search.
+//! @return The paths of the files.
+std::vector<std::filesystem::path> CollectXmlFiles(const std::filesystem::path& directory);
+
+#endif //SDF_LWM2M_CONVERTER_LIB_CONVERTER_INCLUDE_XML_FILES_H_
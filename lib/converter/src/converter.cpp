@@ -14,10 +14,18 @@
  *  limitations under the License.
  */
 
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
 #include <nlohmann/json.hpp>
 #include <pugixml.hpp>
-#include <sdf/sdf_cpp_core.h>
 #include "lwm2m.h"
+#include "lwm2m_stream.h"
+#include "lwm2m_writer.h"
+#include "thread_pool.h"
 #include "converter.h"
 
 using json = nlohmann::ordered_json;
@@ -25,15 +33,178 @@ using json = nlohmann::ordered_json;
 //! Function used to convert sdf to lwm2m
 int ConvertSdfToLwm2m(json& sdf_model_json, json& sdf_mapping_json, pugi::xml_document& lwm2m_xml)
 {
-    // Parse the sdf-model and the sdf-mapping
-    sdf::SdfModel sdf_model = sdf::ParseSdfModel(sdf_model_json);
-    sdf::SdfMapping sdf_mapping = sdf::ParseSdfMapping(sdf_mapping_json);
+    std::vector<lwm2m::Object> objects;
+    if (ConvertSdfToLwm2m(std::as_const(sdf_model_json), std::as_const(sdf_mapping_json), objects) != 0) {
+        return -1;
+    }
 
+    std::string buffer;
+    lwm2m::XmlWriter writer(buffer);
+    writer.BeginDocument();
+    for (const auto& object : objects) {
+        object.Serialize(writer);
+    }
+    writer.EndDocument();
+
+    pugi::xml_parse_result result = lwm2m_xml.load_buffer(buffer.data(), buffer.size());
+    if (!result) {
+        std::cerr << "Failed to parse the generated LwM2M: " << result.description() << std::endl;
+        return -1;
+    }
     return 0;
 }
 
-//! Function used to convert the Matter data model to sdf
+//! Function used to convert sdf to lwm2m objects
+int ConvertSdfToLwm2m(const json& sdf_model_json, const json& sdf_mapping_json, std::vector<lwm2m::Object>& objects)
+{
+    return MapSdfModel(sdf_model_json, sdf_mapping_json, objects);
+}
+
+//! Function used to convert lwm2m to sdf
 int ConvertLwm2mToSdf(const pugi::xml_document& lwm2m_xml, json& sdf_model_json, json& sdf_mapping_json)
 {
+    pugi::xml_node lwm2m_node = lwm2m_xml.child("LWM2M");
+    if (lwm2m_node.empty()) {
+        std::cerr << "No LWM2M element found" << std::endl;
+        return -1;
+    }
+
+    // Every object of the document gets mapped into the same sdf-model and sdf-mapping
+    int result = -1;
+    // The views reference the strings of the document, nothing is copied before the json is built
+    for (const auto object_node : lwm2m_node.children("Object")) {
+        lwm2m::ObjectView object = lwm2m::ObjectView::Parse(object_node);
+        if (MapLwm2mObject(object, sdf_model_json, sdf_mapping_json) != 0) {
+            return -1;
+        }
+        result = 0;
+    }
+    if (result != 0) {
+        std::cerr << "No Object element found" << std::endl;
+    }
+    return result;
+}
+
+namespace {
+
+//! Function used to move the members of a partial result into the result, existing members are merged
+void MergeMembers(json& partial, json& result)
+{
+    for (auto& [key, value] : partial.items()) {
+        json& target = result[key];
+        if (target.is_null()) {
+            target = std::move(value);
+        } else {
+            target.update(value, true);
+        }
+    }
+}
+
+//! Function used to merge the sdf of a single object into the sdf of the whole document
+void MergeObjectSdf(json& partial_model, json& partial_mapping, json& sdf_model_json, json& sdf_mapping_json)
+{
+    // The information block and the namespace of the first object are kept, like in the sequential conversion
+    for (const char* key : {"info", "namespace", "defaultNamespace"}) {
+        if (!sdf_model_json.contains(key) and partial_model.contains(key)) {
+            sdf_model_json[key] = std::move(partial_model[key]);
+        }
+        if (!sdf_mapping_json.contains(key) and partial_mapping.contains(key)) {
+            sdf_mapping_json[key] = std::move(partial_mapping[key]);
+        }
+    }
+    if (partial_model.contains("sdfObject")) {
+        MergeMembers(partial_model["sdfObject"], sdf_model_json["sdfObject"]);
+    }
+    if (partial_mapping.contains("map")) {
+        MergeMembers(partial_mapping["map"], sdf_mapping_json["map"]);
+    }
+}
+
+} // namespace
+
+//! Function used to convert the objects of a lwm2m bundle in parallel
+int ConvertLwm2mToSdf(const pugi::xml_document& lwm2m_xml, json& sdf_model_json, json& sdf_mapping_json,
+                      std::size_t jobs)
+{
+    pugi::xml_node lwm2m_node = lwm2m_xml.child("LWM2M");
+    if (lwm2m_node.empty()) {
+        std::cerr << "No LWM2M element found" << std::endl;
+        return -1;
+    }
+    std::vector<pugi::xml_node> object_nodes;
+    for (const auto object_node : lwm2m_node.children("Object")) {
+        object_nodes.push_back(object_node);
+    }
+    if (object_nodes.size() < 2 or jobs == 1) {
+        return ConvertLwm2mToSdf(lwm2m_xml, sdf_model_json, sdf_mapping_json);
+    }
+
+    // Every worker only writes into the result slot of its own object
+    struct ObjectSdf {
+        json sdf_model;
+        json sdf_mapping;
+        int result = -1;
+    };
+    std::vector<ObjectSdf> results(object_nodes.size());
+    {
+        ThreadPool pool(std::min(jobs == 0 ? std::size_t(std::thread::hardware_concurrency()) : jobs,
+                                 object_nodes.size()));
+        for (std::size_t i = 0; i < object_nodes.size(); i++) {
+            pool.Submit([&object_nodes, &results, i] {
+                try {
+                    lwm2m::ObjectView object = lwm2m::ObjectView::Parse(object_nodes[i]);
+                    results[i].result = MapLwm2mObject(object, results[i].sdf_model, results[i].sdf_mapping);
+                }
+                catch (const std::exception& err) {
+                    std::cerr << "Failed to convert object: " << err.what() << std::endl;
+                }
+            });
+        }
+        pool.Wait();
+    }
+
+    // Merged in document order, so the output does not depend on the scheduling
+    for (auto& object_sdf : results) {
+        if (object_sdf.result != 0) {
+            return -1;
+        }
+        MergeObjectSdf(object_sdf.sdf_model, object_sdf.sdf_mapping, sdf_model_json, sdf_mapping_json);
+    }
+    return 0;
+}
+
+//! Function used to convert lwm2m to sdf while streaming the input
+int ConvertLwm2mToSdf(std::istream& lwm2m_stream, json& sdf_model_json, json& sdf_mapping_json)
+{
+    int result = 0;
+    bool found = false;
+    int parse_result = lwm2m::ParseObjectStream(lwm2m_stream, [&](lwm2m::Object&& object) {
+        found = true;
+        if (MapLwm2mObject(std::move(object), sdf_model_json, sdf_mapping_json) != 0) {
+            result = -1;
+        }
+    });
+    if (parse_result != 0) {
+        return -1;
+    }
+    if (!found) {
+        std::cerr << "No Object element found" << std::endl;
+        return -1;
+    }
+    return result;
+}
+
+//! Function used to convert parsed lwm2m objects to sdf
+int ConvertLwm2mToSdf(std::vector<lwm2m::Object>&& objects, json& sdf_model_json, json& sdf_mapping_json)
+{
+    if (objects.empty()) {
+        std::cerr << "No Object given" << std::endl;
+        return -1;
+    }
+    for (lwm2m::Object& object : objects) {
+        if (MapLwm2mObject(std::move(object), sdf_model_json, sdf_mapping_json) != 0) {
+            return -1;
+        }
+    }
     return 0;
 }
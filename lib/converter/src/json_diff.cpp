@@ -0,0 +1,238 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "json_diff.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include "content_hash.h"
+#include "mapping.h"
+
+using json = nlohmann::ordered_json;
+
+namespace {
+
+//! Distinguishes values of different types with the same content
+enum class Tag : std::uint64_t {
+    Null = 1,
+    Boolean,
+    Number,
+    String,
+    Array,
+    Object,
+    Binary
+};
+
+//! Function used to spread the bits of a hash before combining it
+std::uint64_t Mix(std::uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+std::uint64_t HashTagged(Tag tag, const void* data, std::size_t size)
+{
+    std::uint64_t hash = Mix(static_cast<std::uint64_t>(tag));
+    return HashContent(static_cast<const char*>(data), size, hash);
+}
+
+//! Function used to hash numbers by their value, integral floating point numbers hash like integers
+std::uint64_t HashNumber(const json& value)
+{
+    if (value.is_number_float()) {
+        double number = value.get<double>();
+        if (std::trunc(number) == number and std::abs(number) < 9.0e18) {
+            auto integer = static_cast<std::int64_t>(number);
+            return HashTagged(Tag::Number, &integer, sizeof(integer));
+        }
+        return HashTagged(Tag::Number, &number, sizeof(number));
+    }
+    if (value.is_number_unsigned() and value.get<std::uint64_t>() > std::uint64_t(std::numeric_limits<std::int64_t>::max())) {
+        auto integer = value.get<std::uint64_t>();
+        return HashTagged(Tag::Number, &integer, sizeof(integer));
+    }
+    auto integer = value.get<std::int64_t>();
+    return HashTagged(Tag::Number, &integer, sizeof(integer));
+}
+
+//! Walks two documents and their trees at the same time
+class Differ {
+public:
+    Differ(const JsonMerkleTree& original, const JsonMerkleTree& other, std::size_t max_paths)
+        : original_(original), other_(other), max_paths_(max_paths) {}
+
+    JsonDiff Run()
+    {
+        std::string path;
+        Compare(original_.Json(), 0, other_.Json(), 0, path);
+        return std::move(diff_);
+    }
+
+private:
+    void Report(const std::string& path)
+    {
+        diff_.count++;
+        if (diff_.paths.size() < max_paths_) {
+            diff_.paths.push_back(path.empty() ? std::string("/") : path);
+        }
+    }
+
+    void Compare(const json& original, std::size_t original_node, const json& other, std::size_t other_node,
+                 std::string& path)
+    {
+        // Equal subtrees are skipped without looking at their content
+        if (original_.Hash(original_node) == other_.Hash(other_node)) {
+            return;
+        }
+        if (original.is_object() and other.is_object()) {
+            CompareObjects(original, original_node, other, other_node, path);
+        } else if (original.is_array() and other.is_array()) {
+            CompareArrays(original, original_node, other, other_node, path);
+        } else {
+            Report(path);
+        }
+    }
+
+    void CompareObjects(const json& original, std::size_t original_node, const json& other, std::size_t other_node,
+                        std::string& path)
+    {
+        // Members of the other object by key, together with their position in the tree
+        std::unordered_map<std::string_view, std::pair<const json*, std::size_t>> other_members;
+        other_members.reserve(other.size());
+        std::size_t child = other_node + 1;
+        for (auto it = other.begin(); it != other.end(); ++it) {
+            other_members.emplace(it.key(), std::make_pair(&it.value(), child));
+            child += other_.Size(child);
+        }
+
+        std::size_t length = path.size();
+        child = original_node + 1;
+        for (auto it = original.begin(); it != original.end(); ++it) {
+            path.append("/").append(EscapePointerToken(it.key()));
+            auto member = other_members.find(it.key());
+            if (member == other_members.end()) {
+                Report(path);
+            } else {
+                Compare(it.value(), child, *member->second.first, member->second.second, path);
+                other_members.erase(member);
+            }
+            path.resize(length);
+            child += original_.Size(child);
+        }
+        // Members that were added, in the order of the other object
+        for (auto it = other.begin(); it != other.end(); ++it) {
+            if (other_members.count(it.key()) != 0) {
+                path.append("/").append(EscapePointerToken(it.key()));
+                Report(path);
+                path.resize(length);
+            }
+        }
+    }
+
+    void CompareArrays(const json& original, std::size_t original_node, const json& other, std::size_t other_node,
+                       std::string& path)
+    {
+        std::size_t length = path.size();
+        std::size_t original_child = original_node + 1;
+        std::size_t other_child = other_node + 1;
+        std::size_t common = std::min(original.size(), other.size());
+        for (std::size_t i = 0; i < common; i++) {
+            path.append("/").append(std::to_string(i));
+            Compare(original[i], original_child, other[i], other_child, path);
+            path.resize(length);
+            original_child += original_.Size(original_child);
+            other_child += other_.Size(other_child);
+        }
+        for (std::size_t i = common; i < std::max(original.size(), other.size()); i++) {
+            path.append("/").append(std::to_string(i));
+            Report(path);
+            path.resize(length);
+        }
+    }
+
+    const JsonMerkleTree& original_;
+    const JsonMerkleTree& other_;
+    std::size_t max_paths_;
+    JsonDiff diff_;
+};
+
+} // namespace
+
+JsonMerkleTree::JsonMerkleTree(const json& json) : json_(json)
+{
+    Build(json_);
+}
+
+std::size_t JsonMerkleTree::Build(const json& value)
+{
+    std::size_t index = nodes_.size();
+    nodes_.push_back({0, 1});
+    std::uint64_t hash = 0;
+    switch (value.type()) {
+        case json::value_t::object:
+            // Members are combined by addition, so their order does not matter
+            hash = Mix(static_cast<std::uint64_t>(Tag::Object));
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                std::size_t child = Build(it.value());
+                hash += Mix(HashContent(it.key(), nodes_[child].hash));
+            }
+            break;
+        case json::value_t::array:
+            hash = Mix(static_cast<std::uint64_t>(Tag::Array));
+            for (const auto& element : value) {
+                std::size_t child = Build(element);
+                hash = Mix(hash ^ nodes_[child].hash);
+            }
+            break;
+        case json::value_t::string: {
+            const auto& text = value.get_ref<const json::string_t&>();
+            hash = HashTagged(Tag::String, text.data(), text.size());
+            break;
+        }
+        case json::value_t::boolean: {
+            bool flag = value.get<bool>();
+            hash = HashTagged(Tag::Boolean, &flag, sizeof(flag));
+            break;
+        }
+        case json::value_t::number_integer:
+        case json::value_t::number_unsigned:
+        case json::value_t::number_float:
+            hash = HashNumber(value);
+            break;
+        case json::value_t::binary: {
+            const auto& binary = value.get_binary();
+            hash = HashTagged(Tag::Binary, binary.data(), binary.size());
+            break;
+        }
+        case json::value_t::null:
+        case json::value_t::discarded:
+            hash = Mix(static_cast<std::uint64_t>(Tag::Null));
+            break;
+    }
+    nodes_[index].hash = hash;
+    nodes_[index].size = nodes_.size() - index;
+    return index;
+}
+
+JsonDiff DiffJson(const JsonMerkleTree& original, const JsonMerkleTree& other, std::size_t max_paths)
+{
+    return Differ(original, other, max_paths).Run();
+}
@@ -0,0 +1,177 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "json_writer.h"
+#include <charconv>
+
+using json = nlohmann::ordered_json;
+
+JsonWriter::JsonWriter(std::ostream& stream, int indent) : stream_(stream), indent_(indent)
+{
+    buffer_.reserve(kBufferSize);
+}
+
+JsonWriter::~JsonWriter()
+{
+    Flush();
+}
+
+void JsonWriter::Write(const json& value)
+{
+    WriteValue(value, 0);
+}
+
+int JsonWriter::Flush()
+{
+    if (!buffer_.empty()) {
+        stream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        bytes_written_ += buffer_.size();
+        buffer_.clear();
+    }
+    return stream_ ? 0 : -1;
+}
+
+void JsonWriter::WriteNewline(int level)
+{
+    Append('\n');
+    buffer_.append(static_cast<std::size_t>(indent_) * static_cast<std::size_t>(level), ' ');
+}
+
+void JsonWriter::WriteValue(const json& value, int level)
+{
+    char number[32];
+    switch (value.type()) {
+        case json::value_t::object: {
+            if (value.empty()) {
+                Append("{}");
+                return;
+            }
+            Append('{');
+            bool first = true;
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                if (!first) {
+                    Append(',');
+                }
+                first = false;
+                if (indent_ >= 0) {
+                    WriteNewline(level + 1);
+                }
+                WriteString(it.key());
+                Append(indent_ >= 0 ? std::string_view(": ") : std::string_view(":"));
+                WriteValue(it.value(), level + 1);
+            }
+            if (indent_ >= 0) {
+                WriteNewline(level);
+            }
+            Append('}');
+            return;
+        }
+        case json::value_t::array: {
+            if (value.empty()) {
+                Append("[]");
+                return;
+            }
+            Append('[');
+            bool first = true;
+            for (const auto& element : value) {
+                if (!first) {
+                    Append(',');
+                }
+                first = false;
+                if (indent_ >= 0) {
+                    WriteNewline(level + 1);
+                }
+                WriteValue(element, level + 1);
+            }
+            if (indent_ >= 0) {
+                WriteNewline(level);
+            }
+            Append(']');
+            return;
+        }
+        case json::value_t::string:
+            WriteString(value.get_ref<const json::string_t&>());
+            return;
+        case json::value_t::boolean:
+            Append(value.get<bool>() ? std::string_view("true") : std::string_view("false"));
+            return;
+        case json::value_t::number_integer: {
+            auto result = std::to_chars(number, number + sizeof(number), value.get<json::number_integer_t>());
+            Append(std::string_view(number, static_cast<std::size_t>(result.ptr - number)));
+            return;
+        }
+        case json::value_t::number_unsigned: {
+            auto result = std::to_chars(number, number + sizeof(number), value.get<json::number_unsigned_t>());
+            Append(std::string_view(number, static_cast<std::size_t>(result.ptr - number)));
+            return;
+        }
+        case json::value_t::null:
+            Append("null");
+            return;
+        default:
+            // Floating point numbers keep the shortest round trip format of
+            // nlohmann::json, binary values its representation
+            Append(value.dump());
+            return;
+    }
+}
+
+void JsonWriter::WriteString(std::string_view value)
+{
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+
+    Append('"');
+    std::size_t plain_start = 0;
+    for (std::size_t i = 0; i < value.size(); i++) {
+        auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 and c != '"' and c != '\\') {
+            continue;
+        }
+        // Plain characters are copied in runs instead of one by one
+        Append(value.substr(plain_start, i - plain_start));
+        plain_start = i + 1;
+        switch (c) {
+            case '"':
+                Append("\\\"");
+                break;
+            case '\\':
+                Append("\\\\");
+                break;
+            case '\b':
+                Append("\\b");
+                break;
+            case '\f':
+                Append("\\f");
+                break;
+            case '\n':
+                Append("\\n");
+                break;
+            case '\r':
+                Append("\\r");
+                break;
+            case '\t':
+                Append("\\t");
+                break;
+            default: {
+                char escape[] = {'\\', 'u', '0', '0', kHexDigits[c >> 4], kHexDigits[c & 0xf]};
+                Append(std::string_view(escape, sizeof(escape)));
+                break;
+            }
+        }
+    }
+    Append(value.substr(plain_start));
+    Append('"');
+}
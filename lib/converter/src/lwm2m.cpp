@@ -15,94 +15,258 @@
  */
 
 #include "lwm2m.h"
+#include "lwm2m_tokens.h"
+#include "lwm2m_writer.h"
+#include <algorithm>
+#include <charconv>
+#include <initializer_list>
+#include <iostream>
 #include <pugixml.hpp>
 
 namespace lwm2m {
 
-Resource Resource::Parse(const pugi::xml_node& resource_node) {
-    Resource resource;
-    resource.name = resource_node.child("Name").value();
-    std::string operation = resource_node.child("Operations").value();
-    if (operation == "R") {
-        resource.operations = Read;
-    } else if (operation == "W") {
-        resource.operations = Write;
-    } else if (operation == "RW") {
-        resource.operations = ReadWrite;
-    } else if (operation == "E") {
-        resource.operations = Execute;
-    } else {
-        resource.operations = UndefinedOperation;
+namespace {
+
+//! Function used to format an integer into the given buffer without allocating
+template <std::size_t N>
+std::string_view FormatInteger(int value, char (&buffer)[N]) {
+    auto result = std::to_chars(buffer, buffer + N, value);
+    return std::string_view(buffer, static_cast<std::size_t>(result.ptr - buffer));
+}
+
+} // namespace
+
+template <typename StringType>
+void BasicResource<StringType>::SetField(std::string_view element, std::string_view value) {
+    switch (kResourceFieldTable.Decode(element)) {
+        case ResourceField::Name:
+            name = value;
+            break;
+        case ResourceField::Operations:
+            operations = DecodeOperations(value);
+            break;
+        case ResourceField::MultipleInstances:
+            multiple_instances = DecodeMultipleInstances(value);
+            break;
+        case ResourceField::Mandatory:
+            mandatory = DecodeMandatory(value);
+            break;
+        case ResourceField::Type:
+            type = DecodeType(value);
+            break;
+        case ResourceField::RangeEnumeration:
+            range_enumeration = value;
+            range = ParseRangeEnumeration(value);
+            break;
+        case ResourceField::Units:
+            units = value;
+            break;
+        case ResourceField::Description:
+            description = value;
+            break;
+        case ResourceField::Unknown:
+            break;
     }
+}
 
-    if (resource_node.child("MultipleInstances").value() == "Single") {
-        resource.multiple_instances = false;
-    } else {
-        resource.multiple_instances = true;
+template <typename StringType>
+BasicResource<StringType> BasicResource<StringType>::Parse(const pugi::xml_node& resource_node) {
+    BasicResource resource;
+    for (const auto child_node : resource_node.children()) {
+        if (child_node.type() == pugi::node_element) {
+            resource.SetField(child_node.name(), child_node.child_value());
+        }
     }
-    if (resource_node.child("Mandatory").value() == "Optional") {
-        resource.mandatory = false;
-    } else {
-        resource.mandatory = true;
+    return resource;
+}
+
+template <typename StringType>
+void BasicResource<StringType>::Serialize(int id, XmlWriter& writer) const {
+    char id_text[16];
+    writer.OpenElement(3, "Item", "ID", FormatInteger(id, id_text));
+    writer.TextElement(4, "Name", name);
+    writer.TextElement(4, "Operations", EncodeOperations(operations));
+    writer.TextElement(4, "MultipleInstances", multiple_instances ? "Multiple" : "Single");
+    writer.TextElement(4, "Mandatory", mandatory ? "Mandatory" : "Optional");
+    writer.TextElement(4, "Type", EncodeType(type));
+    writer.TextElement(4, "RangeEnumeration", range_enumeration);
+    writer.TextElement(4, "Units", units);
+    writer.TextElement(4, "Description", description);
+    writer.CloseElement(3, "Item");
+}
+
+template <typename ResourceType>
+void BasicResourceMap<ResourceType>::clear() {
+    resources_.clear();
+    dense_index_.clear();
+}
+
+template <typename ResourceType>
+std::size_t BasicResourceMap<ResourceType>::LowerBound(int id) const {
+    // Resources are usually added in ascending order, so the last position is checked first
+    if (resources_.empty() or resources_.back().first < id) {
+        return resources_.size();
     }
+    auto it = std::lower_bound(resources_.begin(), resources_.end(), id,
+                               [](const value_type& resource, int value) { return resource.first < value; });
+    return static_cast<std::size_t>(it - resources_.begin());
+}
 
-    std::string type = resource_node.child("Type").value();
-    if (type == "String") {
-        resource.type = String;
-    } else if (type == "Integer") {
-        resource.type = Integer;
-    } else if (type == "Float") {
-        resource.type = Float;
-    } else if (type == "Boolean") {
-        resource.type = Boolean;
-    } else if (type == "Opaque") {
-        resource.type = Opaque;
-    } else if (type == "Time") {
-        resource.type = Time;
-    } else if (type == "Objlnk") {
-        resource.type = ObjectLink;
-    } else {
-        resource.type = UndefinedType;
+template <typename ResourceType>
+void BasicResourceMap<ResourceType>::Reindex(std::size_t position) {
+    for (std::size_t i = position; i < resources_.size(); i++) {
+        int id = resources_[i].first;
+        if (id >= 0 and id < kDenseIdLimit) {
+            if (dense_index_.size() <= static_cast<std::size_t>(id)) {
+                dense_index_.resize(static_cast<std::size_t>(id) + 1, 0);
+            }
+            dense_index_[static_cast<std::size_t>(id)] = static_cast<std::uint32_t>(i + 1);
+        }
     }
+}
 
-    resource.range_enumeration = resource_node.child("RangeEnumeration").value();
-    resource.units = resource_node.child("Units").value();
-    resource.description = resource_node.child("Description").value();
-    return resource;
+template <typename ResourceType>
+typename BasicResourceMap<ResourceType>::iterator BasicResourceMap<ResourceType>::find(int id) {
+    if (id >= 0 and id < kDenseIdLimit) {
+        if (static_cast<std::size_t>(id) >= dense_index_.size() or dense_index_[static_cast<std::size_t>(id)] == 0) {
+            return resources_.end();
+        }
+        return resources_.begin() + (dense_index_[static_cast<std::size_t>(id)] - 1);
+    }
+    std::size_t position = LowerBound(id);
+    if (position < resources_.size() and resources_[position].first == id) {
+        return resources_.begin() + static_cast<std::ptrdiff_t>(position);
+    }
+    return resources_.end();
 }
 
-void Resource::Serialize() {
+template <typename ResourceType>
+typename BasicResourceMap<ResourceType>::const_iterator BasicResourceMap<ResourceType>::find(int id) const {
+    return const_cast<BasicResourceMap*>(this)->find(id);
+}
 
+template <typename ResourceType>
+ResourceType& BasicResourceMap<ResourceType>::operator[](int id) {
+    auto it = find(id);
+    if (it != resources_.end()) {
+        return it->second;
+    }
+    std::size_t position = LowerBound(id);
+    resources_.emplace(resources_.begin() + static_cast<std::ptrdiff_t>(position), id, ResourceType());
+    Reindex(position);
+    return resources_[position].second;
 }
 
-Object Object::Parse(const pugi::xml_node& object_node) {
-    Object object;
-    object.name = object_node.child("Name").value();
-    object.object_type = object_node.attribute("ObjectType").value();
-    object.description_1 = object_node.child("Description1").value();
-    object.description_2 = object_node.child("Description2").value();
-    object.object_id = atoi(object_node.child("ObjectID").value());
-    object.object_urn = object_node.child("ObjectURN").value();
-    object.lwm2m_version = atof(object_node.child("LWM2MVersion").value());
-    object.object_version = atof(object_node.child("ObjectVersion").value());
-    if (object_node.child("MultipleInstances").value() == "Single") {
-        object.multiple_instances = false;
-    } else {
-        object.multiple_instances = true;
+template <typename StringType>
+void BasicObject<StringType>::SetField(std::string_view element, std::string_view value) {
+    switch (kObjectFieldTable.Decode(element)) {
+        case ObjectField::Name:
+            name = value;
+            break;
+        case ObjectField::Description1:
+            description_1 = value;
+            break;
+        case ObjectField::Description2:
+            description_2 = value;
+            break;
+        case ObjectField::ObjectID:
+            if (ParseInteger(value, object_id) != 0) {
+                std::cerr << "Invalid ObjectID \"" << value << "\"" << std::endl;
+                object_id = -1;
+            }
+            break;
+        case ObjectField::ObjectURN:
+            object_urn = value;
+            break;
+        case ObjectField::LWM2MVersion:
+            if (!value.empty() and ParseFloat(value, lwm2m_version) != 0) {
+                std::cerr << "Invalid LWM2MVersion \"" << value << "\"" << std::endl;
+            }
+            break;
+        case ObjectField::ObjectVersion:
+            if (!value.empty() and ParseFloat(value, object_version) != 0) {
+                std::cerr << "Invalid ObjectVersion \"" << value << "\"" << std::endl;
+            }
+            break;
+        case ObjectField::MultipleInstances:
+            multiple_instances = DecodeMultipleInstances(value);
+            break;
+        case ObjectField::Mandatory:
+            mandatory = DecodeMandatory(value);
+            break;
+        case ObjectField::Unknown:
+            break;
     }
-    if (object_node.child("Mandatory").value() == "Optional") {
-        object.mandatory = false;
-    } else {
-        object.mandatory = true;
+}
+
+template <typename StringType>
+BasicObject<StringType> BasicObject<StringType>::Parse(const pugi::xml_node& object_node) {
+    BasicObject object;
+    object.object_type = object_node.attribute("ObjectType").value();
+    for (const auto child_node : object_node.children()) {
+        if (child_node.type() == pugi::node_element) {
+            object.SetField(child_node.name(), child_node.child_value());
+        }
     }
-    for (const auto child_node : object_node.child("Resource").children()) {
-        object.resources[child_node.attribute("ID").as_int()] = Resource::Parse(child_node);
+    for (const auto child_node : object_node.child("Resources").children("Item")) {
+        // Items without a valid ID are dropped instead of replacing another resource
+        int id = 0;
+        if (ParseInteger(child_node.attribute("ID").value(), id) != 0) {
+            std::cerr << "Invalid resource ID \"" << child_node.attribute("ID").value() << "\", skipping the resource"
+                      << std::endl;
+            continue;
+        }
+        object.resources[id] = BasicResource<StringType>::Parse(child_node);
     }
     return object;
 }
 
-void Object::Serialize() {
+template <typename StringType>
+void BasicObject<StringType>::Serialize(XmlWriter& writer) const {
+    char number[32];
+    writer.OpenElement(1, "Object", "ObjectType", object_type.empty() ? std::string_view("MODefinition") : object_type);
+    writer.TextElement(2, "Name", name);
+    writer.TextElement(2, "Description1", description_1);
+    writer.TextElement(2, "ObjectID", FormatInteger(object_id, number));
+    writer.TextElement(2, "ObjectURN", object_urn);
+    // Both versions are optional in the schema, unknown versions are left out
+    if (lwm2m_version > 0) {
+        writer.TextElement(2, "LWM2MVersion", FormatVersion(lwm2m_version));
+    }
+    if (object_version > 0) {
+        writer.TextElement(2, "ObjectVersion", FormatVersion(object_version));
+    }
+    writer.TextElement(2, "MultipleInstances", multiple_instances ? "Multiple" : "Single");
+    writer.TextElement(2, "Mandatory", mandatory ? "Mandatory" : "Optional");
+    writer.OpenElement(2, "Resources");
+    for (const auto& [id, resource] : resources) {
+        resource.Serialize(id, writer);
+    }
+    writer.CloseElement(2, "Resources");
+    writer.TextElement(2, "Description2", description_2);
+    writer.CloseElement(1, "Object");
+}
 
+ObjectView ParseObjectView(const pugi::xml_node& object_node, StringArena& arena) {
+    ObjectView object = ObjectView::Parse(object_node);
+    for (std::string_view* value : {&object.name, &object.object_type, &object.description_1,
+                                    &object.description_2, &object.object_urn}) {
+        *value = arena.Store(*value);
+    }
+    for (auto& [id, resource] : object.resources) {
+        for (std::string_view* value : {&resource.name, &resource.range_enumeration, &resource.units,
+                                        &resource.description}) {
+            *value = arena.Store(*value);
+        }
+    }
+    return object;
 }
 
-}
\ No newline at end of file
+template struct BasicResource<std::string>;
+template struct BasicResource<std::string_view>;
+template class BasicResourceMap<Resource>;
+template class BasicResourceMap<ResourceView>;
+template struct BasicObject<std::string>;
+template struct BasicObject<std::string_view>;
+
+}
@@ -0,0 +1,612 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "lwm2m_index.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <pugixml.hpp>
+#include "content_hash.h"
+#include "string_arena.h"
+#include "xml_arena.h"
+#include "xml_files.h"
+
+namespace fs = std::filesystem;
+
+namespace lwm2m {
+
+namespace {
+
+const char kIndexMagic[8] = {'L', 'W', 'M', '2', 'M', 'I', 'D', 'X'};
+//! Written in native byte order, reads back differently on a machine with another byte order
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+//! Every section of the image starts at a multiple of this alignment
+constexpr std::uint64_t kSectionAlignment = 8;
+
+//! Reference to a string inside of the string section
+struct StringRef {
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+struct IndexHeader {
+    char magic[8];
+    std::uint32_t format_version;
+    std::uint32_t byte_order;
+    std::uint32_t file_count;
+    std::uint32_t object_count;
+    std::uint32_t resource_count;
+    std::uint32_t reserved;
+    std::uint64_t files_offset;
+    std::uint64_t objects_offset;
+    std::uint64_t resources_offset;
+    //! Object positions ordered by ObjectID and ObjectVersion
+    std::uint64_t id_order_offset;
+    //! Object positions ordered by ObjectURN
+    std::uint64_t urn_order_offset;
+    std::uint64_t strings_offset;
+    std::uint64_t strings_size;
+};
+
+//! Indexed file, ordered by the path relative to the registry directory
+struct FileRecord {
+    StringRef path;
+    std::int64_t modification_time;
+    std::uint64_t size;
+    std::uint64_t content_hash;
+    std::uint32_t first_object;
+    std::uint32_t object_count;
+};
+
+struct ObjectRecord {
+    StringRef name;
+    StringRef object_type;
+    StringRef description_1;
+    StringRef description_2;
+    StringRef object_urn;
+    std::int32_t object_id;
+    float lwm2m_version;
+    float object_version;
+    std::uint8_t multiple_instances;
+    std::uint8_t mandatory;
+    std::uint16_t reserved;
+    std::uint32_t first_resource;
+    std::uint32_t resource_count;
+};
+
+struct ResourceRecord {
+    std::int32_t id;
+    std::uint8_t operations;
+    std::uint8_t type;
+    std::uint8_t multiple_instances;
+    std::uint8_t mandatory;
+    StringRef name;
+    StringRef range_enumeration;
+    StringRef units;
+    StringRef description;
+};
+
+static_assert(std::is_trivially_copyable_v<IndexHeader> and std::is_trivially_copyable_v<FileRecord> and
+              std::is_trivially_copyable_v<ObjectRecord> and std::is_trivially_copyable_v<ResourceRecord>,
+              "Index records are copied byte wise");
+static_assert(sizeof(IndexHeader) == 88 and sizeof(FileRecord) == 40 and sizeof(ObjectRecord) == 64 and
+              sizeof(ResourceRecord) == 40, "The layout of the index records is part of the format version");
+
+//! Parsed content of a registry file while the index gets updated
+struct FileEntry {
+    std::string path;
+    std::int64_t modification_time = 0;
+    std::uint64_t size = 0;
+    std::uint64_t content_hash = 0;
+    std::vector<ObjectView> objects;
+};
+
+std::uint64_t AlignSection(std::uint64_t offset)
+{
+    return (offset + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+const IndexHeader& Header(const char* image)
+{
+    return *reinterpret_cast<const IndexHeader*>(image);
+}
+
+template <typename Record>
+const Record* Section(const char* image, std::uint64_t offset)
+{
+    return reinterpret_cast<const Record*>(image + offset);
+}
+
+std::string_view Text(const char* image, StringRef ref)
+{
+    return {image + Header(image).strings_offset + ref.offset, ref.size};
+}
+
+bool SectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t record_size, std::uint64_t image_size)
+{
+    return offset % kSectionAlignment == 0 and offset <= image_size and count * record_size <= image_size - offset;
+}
+
+bool StringFits(const IndexHeader& header, StringRef ref)
+{
+    return static_cast<std::uint64_t>(ref.offset) + ref.size <= header.strings_size;
+}
+
+std::int64_t ModificationTime(const fs::file_time_type& time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+//! Function used to parse every object of a mapped registry file into the arena
+int ParseFile(MappedFile& file, const fs::path& path, StringArena& arena, std::vector<ObjectView>& objects)
+{
+    XmlArenaScope arena_scope(ThreadXmlArena());
+    pugi::xml_document document;
+    pugi::xml_parse_result result = document.load_buffer_inplace(file.Data(), file.Size(), kParseOptions);
+    if (!result) {
+        std::cerr << "Failed to parse XML file: " << path.string() << std::endl;
+        std::cerr << "Error description: " << result.description() << std::endl;
+        return -1;
+    }
+    for (const auto object_node : document.child("LWM2M").children("Object")) {
+        ObjectView object = ParseObjectView(object_node, arena);
+        // Objects without a valid ObjectID cannot be found, so they are not indexed
+        if (object.object_id >= 0) {
+            objects.push_back(object);
+        }
+    }
+    return 0;
+}
+
+//! Serializes the collected files into a new index image
+class ImageWriter {
+public:
+    std::string Write(const std::vector<FileEntry>& entries)
+    {
+        for (const auto& entry : entries) {
+            FileRecord file_record{};
+            file_record.path = AddString(entry.path);
+            file_record.modification_time = entry.modification_time;
+            file_record.size = entry.size;
+            file_record.content_hash = entry.content_hash;
+            file_record.first_object = static_cast<std::uint32_t>(objects_.size());
+            file_record.object_count = static_cast<std::uint32_t>(entry.objects.size());
+            files_.push_back(file_record);
+            for (const auto& object : entry.objects) {
+                AddObject(object);
+            }
+        }
+
+        // Lookup orders, equal keys keep the order of the registry
+        std::vector<std::uint32_t> id_order(objects_.size());
+        std::iota(id_order.begin(), id_order.end(), 0);
+        std::vector<std::uint32_t> urn_order = id_order;
+        std::stable_sort(id_order.begin(), id_order.end(), [this](std::uint32_t lhs, std::uint32_t rhs) {
+            const ObjectRecord& left = objects_[lhs];
+            const ObjectRecord& right = objects_[rhs];
+            if (left.object_id != right.object_id) {
+                return left.object_id < right.object_id;
+            }
+            return left.object_version < right.object_version;
+        });
+        std::stable_sort(urn_order.begin(), urn_order.end(), [this](std::uint32_t lhs, std::uint32_t rhs) {
+            return StringOf(objects_[lhs].object_urn) < StringOf(objects_[rhs].object_urn);
+        });
+
+        IndexHeader header{};
+        std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+        header.format_version = ObjectIndex::kFormatVersion;
+        header.byte_order = kByteOrderMark;
+        header.file_count = static_cast<std::uint32_t>(files_.size());
+        header.object_count = static_cast<std::uint32_t>(objects_.size());
+        header.resource_count = static_cast<std::uint32_t>(resources_.size());
+        header.files_offset = AlignSection(sizeof(IndexHeader));
+        header.objects_offset = AlignSection(header.files_offset + files_.size() * sizeof(FileRecord));
+        header.resources_offset = AlignSection(header.objects_offset + objects_.size() * sizeof(ObjectRecord));
+        header.id_order_offset = AlignSection(header.resources_offset + resources_.size() * sizeof(ResourceRecord));
+        header.urn_order_offset = AlignSection(header.id_order_offset + id_order.size() * sizeof(std::uint32_t));
+        header.strings_offset = AlignSection(header.urn_order_offset + urn_order.size() * sizeof(std::uint32_t));
+        header.strings_size = strings_.size();
+
+        std::string image(header.strings_offset + strings_.size(), '\0');
+        std::memcpy(image.data(), &header, sizeof(header));
+        CopySection(image, header.files_offset, files_);
+        CopySection(image, header.objects_offset, objects_);
+        CopySection(image, header.resources_offset, resources_);
+        CopySection(image, header.id_order_offset, id_order);
+        CopySection(image, header.urn_order_offset, urn_order);
+        std::memcpy(image.data() + header.strings_offset, strings_.data(), strings_.size());
+        return image;
+    }
+
+private:
+    //! Add a string to the string section, equal strings are only stored once
+    StringRef AddString(std::string_view value)
+    {
+        auto it = string_refs_.find(value);
+        if (it != string_refs_.end()) {
+            return it->second;
+        }
+        StringRef ref{static_cast<std::uint32_t>(strings_.size()), static_cast<std::uint32_t>(value.size())};
+        strings_.append(value);
+        string_refs_.emplace(value, ref);
+        return ref;
+    }
+
+    std::string_view StringOf(StringRef ref) const
+    {
+        return std::string_view(strings_).substr(ref.offset, ref.size);
+    }
+
+    void AddObject(const ObjectView& object)
+    {
+        ObjectRecord object_record{};
+        object_record.name = AddString(object.name);
+        object_record.object_type = AddString(object.object_type);
+        object_record.description_1 = AddString(object.description_1);
+        object_record.description_2 = AddString(object.description_2);
+        object_record.object_urn = AddString(object.object_urn);
+        object_record.object_id = object.object_id;
+        object_record.lwm2m_version = object.lwm2m_version;
+        object_record.object_version = object.object_version;
+        object_record.multiple_instances = object.multiple_instances;
+        object_record.mandatory = object.mandatory;
+        object_record.first_resource = static_cast<std::uint32_t>(resources_.size());
+        object_record.resource_count = static_cast<std::uint32_t>(object.resources.size());
+        objects_.push_back(object_record);
+
+        for (const auto& [id, resource] : object.resources) {
+            ResourceRecord resource_record{};
+            resource_record.id = id;
+            resource_record.operations = static_cast<std::uint8_t>(resource.operations);
+            resource_record.type = static_cast<std::uint8_t>(resource.type);
+            resource_record.multiple_instances = resource.multiple_instances;
+            resource_record.mandatory = resource.mandatory;
+            resource_record.name = AddString(resource.name);
+            resource_record.range_enumeration = AddString(resource.range_enumeration);
+            resource_record.units = AddString(resource.units);
+            resource_record.description = AddString(resource.description);
+            resources_.push_back(resource_record);
+        }
+    }
+
+    template <typename Record>
+    static void CopySection(std::string& image, std::uint64_t offset, const std::vector<Record>& records)
+    {
+        if (!records.empty()) {
+            std::memcpy(image.data() + offset, records.data(), records.size() * sizeof(Record));
+        }
+    }
+
+    std::vector<FileRecord> files_;
+    std::vector<ObjectRecord> objects_;
+    std::vector<ResourceRecord> resources_;
+    std::string strings_;
+    std::unordered_map<std::string_view, StringRef> string_refs_;
+};
+
+} // namespace
+
+int ObjectIndex::Open(const char* path)
+{
+    if (image_.Open(path) != 0) {
+        return -1;
+    }
+    if (Verify() != 0) {
+        std::cerr << "Incompatible or damaged index: " << path << std::endl;
+        Close();
+        return -1;
+    }
+    return 0;
+}
+
+void ObjectIndex::Close()
+{
+    image_.Close();
+}
+
+int ObjectIndex::Verify() const
+{
+    const char* image = image_.Data();
+    std::uint64_t image_size = image_.Size();
+    if (image_size < sizeof(IndexHeader)) {
+        return -1;
+    }
+    const IndexHeader& header = Header(image);
+    if (std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 or
+        header.format_version != kFormatVersion or header.byte_order != kByteOrderMark) {
+        return -1;
+    }
+    if (!SectionFits(header.files_offset, header.file_count, sizeof(FileRecord), image_size) or
+        !SectionFits(header.objects_offset, header.object_count, sizeof(ObjectRecord), image_size) or
+        !SectionFits(header.resources_offset, header.resource_count, sizeof(ResourceRecord), image_size) or
+        !SectionFits(header.id_order_offset, header.object_count, sizeof(std::uint32_t), image_size) or
+        !SectionFits(header.urn_order_offset, header.object_count, sizeof(std::uint32_t), image_size) or
+        !SectionFits(header.strings_offset, header.strings_size, 1, image_size)) {
+        return -1;
+    }
+
+    // Lookups trust the records, so every reference is checked once when the image is mapped
+    const FileRecord* files = Section<FileRecord>(image, header.files_offset);
+    for (std::uint32_t i = 0; i < header.file_count; i++) {
+        if (!StringFits(header, files[i].path) or
+            static_cast<std::uint64_t>(files[i].first_object) + files[i].object_count > header.object_count) {
+            return -1;
+        }
+    }
+    const ObjectRecord* objects = Section<ObjectRecord>(image, header.objects_offset);
+    for (std::uint32_t i = 0; i < header.object_count; i++) {
+        const ObjectRecord& object = objects[i];
+        if (!StringFits(header, object.name) or !StringFits(header, object.object_type) or
+            !StringFits(header, object.description_1) or !StringFits(header, object.description_2) or
+            !StringFits(header, object.object_urn) or
+            static_cast<std::uint64_t>(object.first_resource) + object.resource_count > header.resource_count) {
+            return -1;
+        }
+    }
+    const ResourceRecord* resources = Section<ResourceRecord>(image, header.resources_offset);
+    for (std::uint32_t i = 0; i < header.resource_count; i++) {
+        const ResourceRecord& resource = resources[i];
+        if (resource.operations > UndefinedOperation or resource.type > UndefinedType or
+            !StringFits(header, resource.name) or !StringFits(header, resource.range_enumeration) or
+            !StringFits(header, resource.units) or !StringFits(header, resource.description)) {
+            return -1;
+        }
+    }
+    for (std::uint64_t offset : {header.id_order_offset, header.urn_order_offset}) {
+        const std::uint32_t* order = Section<std::uint32_t>(image, offset);
+        for (std::uint32_t i = 0; i < header.object_count; i++) {
+            if (order[i] >= header.object_count) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+std::size_t ObjectIndex::Size() const
+{
+    return image_.Data() == nullptr ? 0 : Header(image_.Data()).object_count;
+}
+
+ObjectView ObjectIndex::Get(std::size_t position) const
+{
+    const char* image = image_.Data();
+    const IndexHeader& header = Header(image);
+    const ObjectRecord& record = Section<ObjectRecord>(image, header.objects_offset)[position];
+
+    ObjectView object;
+    object.name = Text(image, record.name);
+    object.object_type = Text(image, record.object_type);
+    object.description_1 = Text(image, record.description_1);
+    object.description_2 = Text(image, record.description_2);
+    object.object_id = record.object_id;
+    object.object_urn = Text(image, record.object_urn);
+    object.lwm2m_version = record.lwm2m_version;
+    object.object_version = record.object_version;
+    object.multiple_instances = record.multiple_instances != 0;
+    object.mandatory = record.mandatory != 0;
+
+    // The resources are stored ordered by their ID, so they are appended to the map
+    const ResourceRecord* resources = Section<ResourceRecord>(image, header.resources_offset) + record.first_resource;
+    object.resources.reserve(record.resource_count);
+    for (std::uint32_t i = 0; i < record.resource_count; i++) {
+        ResourceView& resource = object.resources[resources[i].id];
+        resource.name = Text(image, resources[i].name);
+        resource.operations = static_cast<Operations>(resources[i].operations);
+        resource.multiple_instances = resources[i].multiple_instances != 0;
+        resource.mandatory = resources[i].mandatory != 0;
+        resource.type = static_cast<Type>(resources[i].type);
+        resource.range_enumeration = Text(image, resources[i].range_enumeration);
+        resource.range = ParseRangeEnumeration(resource.range_enumeration);
+        resource.units = Text(image, resources[i].units);
+        resource.description = Text(image, resources[i].description);
+    }
+    return object;
+}
+
+int ObjectIndex::Find(int object_id, ObjectView& object) const
+{
+    if (Size() == 0) {
+        return -1;
+    }
+    const char* image = image_.Data();
+    const IndexHeader& header = Header(image);
+    const ObjectRecord* objects = Section<ObjectRecord>(image, header.objects_offset);
+    const std::uint32_t* begin = Section<std::uint32_t>(image, header.id_order_offset);
+    const std::uint32_t* end = begin + header.object_count;
+
+    // The last entry with the ObjectID has the highest ObjectVersion
+    const std::uint32_t* it = std::upper_bound(begin, end, object_id, [objects](int id, std::uint32_t position) {
+        return id < objects[position].object_id;
+    });
+    if (it == begin or objects[*(it - 1)].object_id != object_id) {
+        return -1;
+    }
+    object = Get(*(it - 1));
+    return 0;
+}
+
+int ObjectIndex::Find(int object_id, float object_version, ObjectView& object) const
+{
+    if (Size() == 0) {
+        return -1;
+    }
+    const char* image = image_.Data();
+    const IndexHeader& header = Header(image);
+    const ObjectRecord* objects = Section<ObjectRecord>(image, header.objects_offset);
+    const std::uint32_t* begin = Section<std::uint32_t>(image, header.id_order_offset);
+    const std::uint32_t* end = begin + header.object_count;
+
+    const std::uint32_t* it = std::lower_bound(begin, end, std::make_pair(object_id, object_version),
+                                               [objects](std::uint32_t position, const std::pair<int, float>& key) {
+        const ObjectRecord& record = objects[position];
+        return std::make_pair(record.object_id, record.object_version) < key;
+    });
+    if (it == end or objects[*it].object_id != object_id or objects[*it].object_version != object_version) {
+        return -1;
+    }
+    object = Get(*it);
+    return 0;
+}
+
+int ObjectIndex::FindByUrn(std::string_view object_urn, ObjectView& object) const
+{
+    if (Size() == 0 or object_urn.empty()) {
+        return -1;
+    }
+    const char* image = image_.Data();
+    const IndexHeader& header = Header(image);
+    const ObjectRecord* objects = Section<ObjectRecord>(image, header.objects_offset);
+    const std::uint32_t* begin = Section<std::uint32_t>(image, header.urn_order_offset);
+    const std::uint32_t* end = begin + header.object_count;
+
+    const std::uint32_t* it = std::lower_bound(begin, end, object_urn,
+                                               [image, objects](std::uint32_t position, std::string_view urn) {
+        return Text(image, objects[position].object_urn) < urn;
+    });
+    if (it == end or Text(image, objects[*it].object_urn) != object_urn) {
+        return -1;
+    }
+    object = Get(*it);
+    return 0;
+}
+
+int ObjectIndex::Update(const std::string& directory, const char* path)
+{
+    std::error_code error_code;
+    // A missing or incompatible image is rebuilt from scratch
+    if (image_.Data() == nullptr and fs::exists(path, error_code)) {
+        if (Open(path) != 0) {
+            std::cerr << "Rebuilding index: " << path << std::endl;
+        }
+    }
+
+    std::vector<fs::path> files;
+    try {
+        files = CollectXmlFiles(directory);
+    }
+    catch (const std::exception& err) {
+        std::cerr << "Failed to read directory: " << directory << std::endl;
+        std::cerr << err.what() << std::endl;
+        return -1;
+    }
+
+    const char* image = image_.Data();
+    const FileRecord* old_begin = nullptr;
+    const FileRecord* old_end = nullptr;
+    if (image != nullptr) {
+        old_begin = Section<FileRecord>(image, Header(image).files_offset);
+        old_end = old_begin + Header(image).file_count;
+    }
+    // Removed files also require a new image
+    bool changed = image == nullptr or static_cast<std::size_t>(old_end - old_begin) != files.size();
+
+    StringArena arena;
+    std::vector<FileEntry> entries(files.size());
+    for (std::size_t i = 0; i < files.size(); i++) {
+        // The files are ordered by their relative path, which the records are looked up by
+        const fs::path& file_path = files[i];
+        const std::string relative_path = file_path.lexically_relative(directory).generic_string();
+        FileEntry& entry = entries[i];
+        entry.path = relative_path;
+        auto modification_time = fs::last_write_time(file_path, error_code);
+        if (error_code) {
+            std::cerr << "Failed to stat file: " << file_path.string() << std::endl;
+            return -1;
+        }
+        entry.modification_time = ModificationTime(modification_time);
+        entry.size = fs::file_size(file_path, error_code);
+        if (error_code) {
+            std::cerr << "Failed to stat file: " << file_path.string() << std::endl;
+            return -1;
+        }
+
+        const FileRecord* old_record = nullptr;
+        if (image != nullptr) {
+            const FileRecord* it = std::lower_bound(old_begin, old_end, std::string_view(relative_path),
+                                                    [image](const FileRecord& record, std::string_view value) {
+                return Text(image, record.path) < value;
+            });
+            if (it != old_end and Text(image, it->path) == relative_path) {
+                old_record = it;
+            }
+        }
+
+        // Unchanged metadata is trusted without reading the file
+        bool reuse = old_record != nullptr and old_record->modification_time == entry.modification_time and
+                     old_record->size == entry.size;
+        if (reuse) {
+            entry.content_hash = old_record->content_hash;
+        } else {
+            changed = true;
+            MappedFile file;
+            if (file.Open(file_path.string().c_str(), true) != 0) {
+                return -1;
+            }
+            entry.content_hash = HashContent(file.Data(), file.Size());
+            // A touched file with the same content keeps its objects
+            reuse = old_record != nullptr and old_record->content_hash == entry.content_hash;
+            if (!reuse) {
+                // Broken files are recorded without objects, so they are only parsed again once they change
+                ParseFile(file, file_path, arena, entry.objects);
+            }
+        }
+        if (reuse) {
+            for (std::uint32_t j = 0; j < old_record->object_count; j++) {
+                entry.objects.push_back(Get(old_record->first_object + j));
+            }
+        }
+    }
+
+    if (!changed) {
+        return 0;
+    }
+
+    ImageWriter writer;
+    std::string new_image = writer.Write(entries);
+    std::string temporary_path = std::string(path) + ".tmp";
+    {
+        std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            std::cerr << "Failed to create index: " << temporary_path << std::endl;
+            return -1;
+        }
+        stream.write(new_image.data(), static_cast<std::streamsize>(new_image.size()));
+        if (!stream) {
+            std::cerr << "Failed to write index: " << temporary_path << std::endl;
+            return -1;
+        }
+    }
+    // The reused objects reference the old image, so it is only unmapped once the new one is written
+    Close();
+    fs::rename(temporary_path, path, error_code);
+    if (error_code) {
+        std::cerr << "Failed to replace index: " << path << ": " << error_code.message() << std::endl;
+        return -1;
+    }
+    return Open(path);
+}
+
+}
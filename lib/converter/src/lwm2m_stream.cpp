@@ -0,0 +1,530 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "lwm2m_stream.h"
+#include "range_enumeration.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace lwm2m {
+
+namespace {
+
+typedef std::char_traits<char> Traits;
+
+//! Function used to check for xml whitespace
+bool IsWhitespace(int c)
+{
+    return c == ' ' or c == '\t' or c == '\n' or c == '\r';
+}
+
+//! Function used to append a unicode code point as utf-8
+void AppendUtf8(unsigned long code_point, std::string& output)
+{
+    if (code_point < 0x80) {
+        output.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        output.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        output.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        output.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+//! Single pass parser for the xml subset used by lwm2m object definitions
+class StreamParser {
+public:
+    StreamParser(std::streambuf& buffer, const ObjectCallback& callback) : buffer_(buffer), callback_(callback) {}
+
+    //! Parse the whole stream, returns 0 on success and negative on failure
+    int Parse();
+
+    const std::string& Error() const { return error_; }
+
+private:
+    //! Position inside of the lwm2m structure
+    enum class Context { kDocument, kObject, kResources, kItem };
+
+    int Get() { return buffer_.sbumpc(); }
+    int Peek() { return buffer_.sgetc(); }
+    bool Fail(const char* message);
+
+    void SkipWhitespace();
+    bool SkipUntil(const char* terminator);
+    bool ReadName(std::string& name);
+    bool ReadEntity(std::string& output);
+    bool ReadText();
+    bool ReadCdata();
+    bool ReadMarkupDeclaration();
+    bool ReadStartTag();
+    bool ReadEndTag();
+
+    void StartElement();
+    void EndElement();
+    void AppendText(int c);
+
+    std::streambuf& buffer_;
+    const ObjectCallback& callback_;
+    std::string error_;
+
+    std::vector<std::string> open_elements_;
+    std::string name_;
+    std::string attribute_name_;
+    std::string attribute_value_;
+    std::string object_type_;
+    int item_id_ = 0;
+    //! The start tag has an ID attribute holding an integer
+    bool item_id_valid_ = false;
+
+    Context context_ = Context::kDocument;
+    std::size_t object_depth_ = 0;
+    Object object_;
+    Resource resource_;
+    int resource_id_ = 0;
+    bool resource_id_valid_ = false;
+
+    //! Text of the object or resource field that is currently open
+    bool collecting_ = false;
+    std::size_t field_depth_ = 0;
+    std::string field_;
+    std::string text_;
+    //! The first text node of the field was read, like child_value() of pugixml the others are ignored
+    bool text_complete_ = false;
+};
+
+bool StreamParser::Fail(const char* message)
+{
+    if (error_.empty()) {
+        error_ = message;
+    }
+    return false;
+}
+
+void StreamParser::SkipWhitespace()
+{
+    while (IsWhitespace(Peek())) {
+        Get();
+    }
+}
+
+//! Function used to skip everything up to and including the terminator
+bool StreamParser::SkipUntil(const char* terminator)
+{
+    std::size_t length = Traits::length(terminator);
+    std::string window;
+    while (window.size() < length or window.compare(window.size() - length, length, terminator) != 0) {
+        int c = Get();
+        if (c == Traits::eof()) {
+            return Fail("Unexpected end of file");
+        }
+        // Only the last characters are needed to detect the terminator
+        if (window.size() == length) {
+            window.erase(0, 1);
+        }
+        window.push_back(static_cast<char>(c));
+    }
+    return true;
+}
+
+bool StreamParser::ReadName(std::string& name)
+{
+    name.clear();
+    int c = Peek();
+    while (c != Traits::eof() and !IsWhitespace(c) and c != '/' and c != '>' and c != '=') {
+        name.push_back(static_cast<char>(Get()));
+        c = Peek();
+    }
+    if (name.empty()) {
+        return Fail("Expected a name");
+    }
+    return true;
+}
+
+//! Function used to decode an entity reference, the ampersand has already been read
+bool StreamParser::ReadEntity(std::string& output)
+{
+    std::string entity;
+    int c = Get();
+    while (c != ';') {
+        if (c == Traits::eof() or entity.size() > 10) {
+            return Fail("Invalid entity reference");
+        }
+        entity.push_back(static_cast<char>(c));
+        c = Get();
+    }
+
+    if (entity == "lt") {
+        output.push_back('<');
+    } else if (entity == "gt") {
+        output.push_back('>');
+    } else if (entity == "amp") {
+        output.push_back('&');
+    } else if (entity == "quot") {
+        output.push_back('"');
+    } else if (entity == "apos") {
+        output.push_back('\'');
+    } else if (entity.size() > 1 and entity[0] == '#') {
+        bool hex = entity[1] == 'x';
+        unsigned long code_point = std::stoul(entity.substr(hex ? 2 : 1), nullptr, hex ? 16 : 10);
+        AppendUtf8(code_point, output);
+    } else {
+        // Unknown entities are kept as they are
+        output.push_back('&');
+        output.append(entity);
+        output.push_back(';');
+    }
+    return true;
+}
+
+//! Function used to append a character of text with end of line normalization
+void StreamParser::AppendText(int c)
+{
+    if (c == '\r') {
+        if (Peek() == '\n') {
+            Get();
+        }
+        c = '\n';
+    }
+    text_.push_back(static_cast<char>(c));
+}
+
+//! Function used to read the text up to the next markup
+bool StreamParser::ReadText()
+{
+    bool keep = collecting_ and open_elements_.size() == field_depth_ and !text_complete_;
+    // Text consisting only of whitespace does not form a node, the same way pugixml does by default
+    bool whitespace_only = true;
+    int c = Peek();
+    while (c != Traits::eof() and c != '<') {
+        Get();
+        whitespace_only = whitespace_only and IsWhitespace(c);
+        if (!keep) {
+            // Text outside of a field is never used, so entities do not need to be decoded
+        } else if (c == '&') {
+            if (!ReadEntity(text_)) {
+                return false;
+            }
+        } else {
+            AppendText(c);
+        }
+        c = Peek();
+    }
+    if (keep) {
+        if (whitespace_only) {
+            text_.clear();
+        } else {
+            text_complete_ = true;
+        }
+    }
+    return true;
+}
+
+//! Function used to read a cdata section, "<![CDATA[" has already been read
+bool StreamParser::ReadCdata()
+{
+    bool keep = collecting_ and open_elements_.size() == field_depth_ and !text_complete_;
+    std::size_t start = text_.size();
+    while (true) {
+        int c = Get();
+        if (c == Traits::eof()) {
+            return Fail("Unexpected end of file");
+        }
+        AppendText(c);
+        // The cdata section ends with "]]>", which is removed from the collected text again
+        if (text_.size() - start >= 3 and text_.compare(text_.size() - 3, 3, "]]>") == 0) {
+            text_.resize(text_.size() - 3);
+            break;
+        }
+    }
+    if (keep) {
+        // Cdata sections always form a node, even if they are empty
+        text_complete_ = true;
+    } else {
+        text_.resize(start);
+    }
+    return true;
+}
+
+//! Function used to read comments, cdata sections and doctype declarations, "<!" has already been read
+bool StreamParser::ReadMarkupDeclaration()
+{
+    if (Peek() == '-') {
+        Get();
+        if (Get() != '-') {
+            return Fail("Invalid comment");
+        }
+        return SkipUntil("-->");
+    }
+    if (Peek() == '[') {
+        for (const char* expected = "[CDATA["; *expected != '\0'; expected++) {
+            if (Get() != *expected) {
+                return Fail("Invalid CDATA section");
+            }
+        }
+        return ReadCdata();
+    }
+
+    // Doctype declarations are skipped including an internal subset
+    int nesting = 0;
+    while (true) {
+        int c = Get();
+        if (c == Traits::eof()) {
+            return Fail("Unexpected end of file");
+        } else if (c == '[') {
+            nesting++;
+        } else if (c == ']') {
+            nesting--;
+        } else if (c == '>' and nesting <= 0) {
+            return true;
+        }
+    }
+}
+
+//! Function used to read a start tag, "<" has already been read
+bool StreamParser::ReadStartTag()
+{
+    if (!ReadName(name_)) {
+        return false;
+    }
+    object_type_.clear();
+    item_id_ = 0;
+    item_id_valid_ = false;
+
+    while (true) {
+        SkipWhitespace();
+        int c = Peek();
+        if (c == Traits::eof()) {
+            return Fail("Unexpected end of file");
+        }
+        if (c == '>') {
+            Get();
+            StartElement();
+            return true;
+        }
+        if (c == '/') {
+            Get();
+            if (Get() != '>') {
+                return Fail("Invalid empty element tag");
+            }
+            StartElement();
+            EndElement();
+            return true;
+        }
+
+        // Read the attribute, only the ones needed for lwm2m are kept
+        if (!ReadName(attribute_name_)) {
+            return false;
+        }
+        SkipWhitespace();
+        if (Get() != '=') {
+            return Fail("Expected '=' after attribute name");
+        }
+        SkipWhitespace();
+        int quote = Get();
+        if (quote != '"' and quote != '\'') {
+            return Fail("Expected quoted attribute value");
+        }
+        attribute_value_.clear();
+        for (c = Get(); c != quote; c = Get()) {
+            if (c == Traits::eof()) {
+                return Fail("Unexpected end of file");
+            }
+            if (c == '&') {
+                if (!ReadEntity(attribute_value_)) {
+                    return false;
+                }
+            } else {
+                attribute_value_.push_back(static_cast<char>(c));
+            }
+        }
+        if (attribute_name_ == "ObjectType") {
+            object_type_ = attribute_value_;
+        } else if (attribute_name_ == "ID") {
+            item_id_valid_ = ParseInteger(attribute_value_, item_id_) == 0;
+        }
+    }
+}
+
+//! Function used to read an end tag, "</" has already been read
+bool StreamParser::ReadEndTag()
+{
+    if (!ReadName(name_)) {
+        return false;
+    }
+    SkipWhitespace();
+    if (Get() != '>') {
+        return Fail("Invalid end tag");
+    }
+    if (open_elements_.empty() or open_elements_.back() != name_) {
+        return Fail("Mismatched end tag");
+    }
+    EndElement();
+    return true;
+}
+
+//! Function used to track the position inside of the lwm2m structure when an element is opened
+void StreamParser::StartElement()
+{
+    open_elements_.push_back(name_);
+    std::size_t depth = open_elements_.size();
+
+    bool field = false;
+    switch (context_) {
+        case Context::kDocument:
+            if (depth == 2 and name_ == "Object" and open_elements_.front() == "LWM2M") {
+                context_ = Context::kObject;
+                object_depth_ = depth;
+                object_ = Object();
+                object_.object_type = object_type_;
+            }
+            break;
+        case Context::kObject:
+            if (depth == object_depth_ + 1) {
+                if (name_ == "Resources") {
+                    context_ = Context::kResources;
+                } else {
+                    field = true;
+                }
+            }
+            break;
+        case Context::kResources:
+            if (depth == object_depth_ + 2 and name_ == "Item") {
+                context_ = Context::kItem;
+                resource_ = Resource();
+                resource_id_ = item_id_;
+                resource_id_valid_ = item_id_valid_;
+                if (!resource_id_valid_) {
+                    std::cerr << "Resource item without a valid ID, skipping the resource" << std::endl;
+                }
+            }
+            break;
+        case Context::kItem:
+            field = depth == object_depth_ + 3;
+            break;
+    }
+
+    if (field) {
+        collecting_ = true;
+        field_depth_ = depth;
+        field_ = name_;
+        text_.clear();
+        text_complete_ = false;
+    }
+}
+
+//! Function used to hand over the parsed fields, resources and objects when an element is closed
+void StreamParser::EndElement()
+{
+    std::size_t depth = open_elements_.size();
+
+    if (collecting_ and depth == field_depth_) {
+        if (context_ == Context::kItem) {
+            resource_.SetField(field_, text_);
+        } else {
+            object_.SetField(field_, text_);
+        }
+        collecting_ = false;
+        field_depth_ = 0;
+    } else if (context_ == Context::kItem and depth == object_depth_ + 2) {
+        // Items without a valid ID are dropped instead of replacing another resource
+        if (resource_id_valid_) {
+            object_.resources[resource_id_] = std::move(resource_);
+        }
+        context_ = Context::kResources;
+    } else if (context_ == Context::kResources and depth == object_depth_ + 1) {
+        context_ = Context::kObject;
+    } else if (context_ == Context::kObject and depth == object_depth_) {
+        callback_(std::move(object_));
+        object_ = Object();
+        context_ = Context::kDocument;
+    }
+
+    open_elements_.pop_back();
+}
+
+int StreamParser::Parse()
+{
+    while (true) {
+        if (!ReadText()) {
+            return -1;
+        }
+        int c = Get();
+        if (c == Traits::eof()) {
+            break;
+        }
+        // c is always '<' at this point
+        bool success;
+        switch (Peek()) {
+            case '?':
+                success = SkipUntil("?>");
+                break;
+            case '!':
+                Get();
+                success = ReadMarkupDeclaration();
+                break;
+            case '/':
+                Get();
+                success = ReadEndTag();
+                break;
+            default:
+                success = ReadStartTag();
+                break;
+        }
+        if (!success) {
+            return -1;
+        }
+    }
+
+    if (!open_elements_.empty()) {
+        Fail("Unexpected end of file");
+        return -1;
+    }
+    return 0;
+}
+
+} // namespace
+
+//! Function used to parse lwm2m objects from a stream in a single pass
+int ParseObjectStream(std::istream& input, const ObjectCallback& callback)
+{
+    if (input.rdbuf() == nullptr) {
+        std::cerr << "Failed to parse XML stream: No input" << std::endl;
+        return -1;
+    }
+    StreamParser parser(*input.rdbuf(), callback);
+    int result;
+    try {
+        result = parser.Parse();
+    }
+    catch (const std::exception& err) {
+        std::cerr << "Failed to parse XML stream: " << err.what() << std::endl;
+        return -1;
+    }
+    if (result != 0) {
+        std::cerr << "Failed to parse XML stream: " << parser.Error() << std::endl;
+    }
+    return result;
+}
+
+}
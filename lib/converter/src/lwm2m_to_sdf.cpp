@@ -1,3 +1,241 @@
-//
-// Created by Niklas on 07.11.2024.
-//
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <nlohmann/json.hpp>
+#include "lwm2m.h"
+#include "lwm2m_tokens.h"
+#include "mapping.h"
+#include "range_enumeration.h"
+#include "lwm2m_to_sdf.h"
+
+using json = nlohmann::ordered_json;
+
+namespace {
+
+//! Function used to turn a string of an object into json, strings of mutable owning objects are moved
+template <typename StringType>
+json TakeString(StringType& value)
+{
+    if constexpr (std::is_same_v<StringType, std::string>) {
+        return json(std::move(value));
+    } else {
+        return json(value);
+    }
+}
+
+//! Function used to map a lwm2m type onto sdf data qualities
+void MapType(lwm2m::Type type, json& data_qualities)
+{
+    const lwm2m::SdfType& sdf_type = lwm2m::MapTypeToSdf(type);
+    if (sdf_type.type.empty()) {
+        return;
+    }
+    data_qualities["type"] = sdf_type.type;
+    if (!sdf_type.sdf_type.empty()) {
+        data_qualities["sdfType"] = sdf_type.sdf_type;
+    }
+    if (sdf_type.unsigned_integer) {
+        data_qualities["minimum"] = 0;
+    }
+}
+
+//! Function used to turn a number of a RangeEnumeration into json, integral values stay integers
+json RangeNumber(double value)
+{
+    if (value == std::trunc(value) and std::abs(value) < 9007199254740992.0) {
+        return static_cast<std::int64_t>(value);
+    }
+    return value;
+}
+
+//! Function used to map a parsed RangeEnumeration onto the data qualities of a lwm2m type
+//! Returns false if the RangeEnumeration has no sdf equivalent for the type
+bool MapRangeEnumeration(const lwm2m::RangeEnumeration& range_enumeration, lwm2m::Type type,
+                         json& data_qualities)
+{
+    const std::string_view sdf_type = lwm2m::MapTypeToSdf(type).type;
+    bool number = sdf_type == "integer" or sdf_type == "number";
+    switch (range_enumeration.kind) {
+        case lwm2m::RangeKind::None:
+            return true;
+        case lwm2m::RangeKind::Range:
+            if (number) {
+                data_qualities["minimum"] = RangeNumber(range_enumeration.minimum);
+                data_qualities["maximum"] = RangeNumber(range_enumeration.maximum);
+                return true;
+            }
+            // The range of a string limits its length
+            if (type == lwm2m::String and range_enumeration.minimum >= 0) {
+                data_qualities["minLength"] = RangeNumber(range_enumeration.minimum);
+                data_qualities["maxLength"] = RangeNumber(range_enumeration.maximum);
+                return true;
+            }
+            return false;
+        case lwm2m::RangeKind::Enumeration:
+            if (number) {
+                json& values = data_qualities["enum"];
+                for (double value : range_enumeration.values) {
+                    values.push_back(RangeNumber(value));
+                }
+                return true;
+            }
+            return false;
+        case lwm2m::RangeKind::Invalid:
+            return false;
+    }
+    return false;
+}
+
+//! Function used to map a lwm2m resource onto a sdfProperty or a sdfAction
+//! The strings of a mutable resource are moved, they are empty afterwards
+template <typename ResourceType>
+void MapResource(int id, ResourceType& resource, const std::string& object_pointer,
+                 json& sdf_object, json& sdf_required, json& map)
+{
+    std::string pointer;
+    const lwm2m::SdfOperations& sdf_operations = lwm2m::MapOperationsToSdf(resource.operations);
+    // Executable resources are mapped onto sdfAction, everything else onto sdfProperty
+    if (sdf_operations.action) {
+        json& sdf_action = sdf_object["sdfAction"][std::string(resource.name)];
+        pointer = object_pointer + "/sdfAction/" + EscapePointerToken(resource.name);
+        sdf_action["label"] = TakeString(resource.name);
+        if (!resource.description.empty()) {
+            sdf_action["description"] = TakeString(resource.description);
+        }
+    } else {
+        json& sdf_property = sdf_object["sdfProperty"][std::string(resource.name)];
+        pointer = object_pointer + "/sdfProperty/" + EscapePointerToken(resource.name);
+        sdf_property["label"] = TakeString(resource.name);
+        if (!resource.description.empty()) {
+            sdf_property["description"] = TakeString(resource.description);
+        }
+        // Resources with multiple instances are represented as an array of the resource type
+        if (resource.multiple_instances) {
+            sdf_property["type"] = "array";
+        }
+        json& data_qualities = resource.multiple_instances ? sdf_property["items"] : sdf_property;
+        MapType(resource.type, data_qualities);
+        // The RangeEnumeration is always kept inside the mapping, so it can be written back unchanged
+        if (!MapRangeEnumeration(resource.range, resource.type, data_qualities)) {
+            std::cerr << "RangeEnumeration \"" << resource.range_enumeration << "\" of " << pointer
+                      << " has no sdf equivalent, keeping it only inside the sdf-mapping" << std::endl;
+        }
+        if (!resource.units.empty()) {
+            sdf_property["unit"] = TakeString(resource.units);
+        }
+        sdf_property["readable"] = sdf_operations.readable;
+        sdf_property["writable"] = sdf_operations.writable;
+    }
+
+    if (resource.mandatory) {
+        sdf_required.push_back(pointer);
+    }
+
+    // Information without a sdf equivalent is kept inside the mapping
+    json& mapping = map[std::move(pointer)];
+    mapping["id"] = id;
+    mapping["operations"] = lwm2m::EncodeOperations(resource.operations);
+    mapping["type"] = lwm2m::EncodeType(resource.type);
+    mapping["multipleInstances"] = resource.multiple_instances;
+    mapping["mandatory"] = resource.mandatory;
+    if (!resource.range_enumeration.empty()) {
+        mapping["rangeEnumeration"] = TakeString(resource.range_enumeration);
+    }
+}
+
+//! Function used to map a lwm2m object onto a sdfObject, shared by owning objects and views
+//! The strings of a mutable object are moved, they are empty afterwards
+template <typename ObjectType>
+int MapObject(ObjectType& object, json& sdf_model_json, json& sdf_mapping_json)
+{
+    if (object.name.empty()) {
+        std::cerr << "Object " << object.object_id << " has no name, skipping" << std::endl;
+        return -1;
+    }
+    if (object.object_id < 0) {
+        std::cerr << "Object " << object.name << " has no valid ObjectID, skipping" << std::endl;
+        return -1;
+    }
+
+    // Only the first mapped object determines the information block
+    if (!sdf_model_json.contains("info")) {
+        sdf_model_json["info"]["title"] = object.name;
+        sdf_model_json["info"]["version"] = lwm2m::FormatVersion(object.object_version);
+    }
+    for (json* sdf_json : {&sdf_model_json, &sdf_mapping_json}) {
+        if (!sdf_json->contains("namespace")) {
+            (*sdf_json)["namespace"][kLwm2mNamespacePrefix] = kLwm2mNamespace;
+            (*sdf_json)["defaultNamespace"] = kLwm2mNamespacePrefix;
+        }
+    }
+
+    json& sdf_object = sdf_model_json["sdfObject"][std::string(object.name)];
+    std::string object_pointer = "#/sdfObject/" + EscapePointerToken(object.name);
+    sdf_object["label"] = TakeString(object.name);
+    if (!object.description_1.empty()) {
+        sdf_object["description"] = TakeString(object.description_1);
+    }
+
+    json& map = sdf_mapping_json["map"];
+    json& mapping = map[object_pointer];
+    mapping["id"] = object.object_id;
+    mapping["objectURN"] = TakeString(object.object_urn);
+    mapping["objectType"] = TakeString(object.object_type);
+    mapping["lwm2mVersion"] = lwm2m::FormatVersion(object.lwm2m_version);
+    mapping["objectVersion"] = lwm2m::FormatVersion(object.object_version);
+    mapping["multipleInstances"] = object.multiple_instances;
+    mapping["mandatory"] = object.mandatory;
+    if (!object.description_2.empty()) {
+        mapping["description2"] = TakeString(object.description_2);
+    }
+
+    json sdf_required = json::array();
+    for (auto& [id, resource] : object.resources) {
+        MapResource(id, resource, object_pointer, sdf_object, sdf_required, map);
+    }
+    if (!sdf_required.empty()) {
+        sdf_object["sdfRequired"] = std::move(sdf_required);
+    }
+
+    return 0;
+}
+
+} // namespace
+
+//! Function used to map a lwm2m object onto a sdfObject
+int MapLwm2mObject(const lwm2m::Object& object, json& sdf_model_json, json& sdf_mapping_json)
+{
+    return MapObject(object, sdf_model_json, sdf_mapping_json);
+}
+
+//! Function used to map a lwm2m object view onto a sdfObject
+int MapLwm2mObject(const lwm2m::ObjectView& object, json& sdf_model_json, json& sdf_mapping_json)
+{
+    return MapObject(object, sdf_model_json, sdf_mapping_json);
+}
+
+//! Function used to map a lwm2m object onto a sdfObject while moving its strings
+int MapLwm2mObject(lwm2m::Object&& object, json& sdf_model_json, json& sdf_mapping_json)
+{
+    return MapObject(object, sdf_model_json, sdf_mapping_json);
+}
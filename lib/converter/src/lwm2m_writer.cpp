@@ -0,0 +1,156 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "lwm2m_writer.h"
+
+namespace lwm2m {
+
+namespace {
+
+//! Declaration and root element of the OMA registry files
+const char* const kDocumentBegin =
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<LWM2M xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+        "xsi:noNamespaceSchemaLocation=\"http://www.openmobilealliance.org/tech/profiles/LWM2M-v1_1.xsd\">\n";
+const char* const kDocumentEnd = "</LWM2M>\n";
+
+} // namespace
+
+XmlWriter::XmlWriter(std::ostream& stream) : stream_(&stream), output_(&buffer_)
+{
+    buffer_.reserve(kBufferSize);
+}
+
+XmlWriter::XmlWriter(std::string& output) : output_(&output), bytes_written_(output.size()) {}
+
+XmlWriter::~XmlWriter()
+{
+    Flush();
+}
+
+std::uint64_t XmlWriter::BytesWritten() const
+{
+    if (stream_ == nullptr) {
+        return output_->size() - bytes_written_;
+    }
+    return bytes_written_ + buffer_.size();
+}
+
+int XmlWriter::Flush()
+{
+    if (stream_ == nullptr) {
+        return 0;
+    }
+    if (!buffer_.empty()) {
+        stream_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        bytes_written_ += buffer_.size();
+        buffer_.clear();
+    }
+    return *stream_ ? 0 : -1;
+}
+
+void XmlWriter::EndLine()
+{
+    output_->push_back('\n');
+    if (stream_ != nullptr and buffer_.size() >= kBufferSize) {
+        Flush();
+    }
+}
+
+void XmlWriter::BeginDocument()
+{
+    output_->append(kDocumentBegin);
+}
+
+void XmlWriter::EndDocument()
+{
+    output_->append(kDocumentEnd);
+}
+
+void XmlWriter::OpenElement(int depth, std::string_view name)
+{
+    Indent(depth);
+    output_->push_back('<');
+    output_->append(name);
+    output_->push_back('>');
+    EndLine();
+}
+
+void XmlWriter::OpenElement(int depth, std::string_view name, std::string_view attribute, std::string_view value)
+{
+    Indent(depth);
+    output_->push_back('<');
+    output_->append(name);
+    output_->push_back(' ');
+    output_->append(attribute);
+    output_->append("=\"");
+    WriteEscaped(value);
+    output_->append("\">");
+    EndLine();
+}
+
+void XmlWriter::CloseElement(int depth, std::string_view name)
+{
+    Indent(depth);
+    output_->append("</");
+    output_->append(name);
+    output_->push_back('>');
+    EndLine();
+}
+
+void XmlWriter::TextElement(int depth, std::string_view name, std::string_view text)
+{
+    Indent(depth);
+    output_->push_back('<');
+    output_->append(name);
+    output_->push_back('>');
+    WriteEscaped(text);
+    output_->append("</");
+    output_->append(name);
+    output_->push_back('>');
+    EndLine();
+}
+
+void XmlWriter::WriteEscaped(std::string_view text)
+{
+    std::size_t plain_start = 0;
+    for (std::size_t i = 0; i < text.size(); i++) {
+        std::string_view entity;
+        switch (text[i]) {
+            case '&':
+                entity = "&amp;";
+                break;
+            case '<':
+                entity = "&lt;";
+                break;
+            case '>':
+                entity = "&gt;";
+                break;
+            case '"':
+                entity = "&quot;";
+                break;
+            default:
+                continue;
+        }
+        // Plain characters are copied in runs instead of one by one
+        output_->append(text.substr(plain_start, i - plain_start));
+        output_->append(entity);
+        plain_start = i + 1;
+    }
+    output_->append(text.substr(plain_start));
+}
+
+}
@@ -0,0 +1,168 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "mapped_file.h"
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+void MappedFile::Prefetch() const
+{
+    // Touching a single byte per page faults the whole page in
+    constexpr std::size_t kPageSize = 4096;
+    volatile std::uint8_t sink = 0;
+    for (std::size_t offset = 0; offset < size_; offset += kPageSize) {
+        sink = sink ^ static_cast<std::uint8_t>(data_[offset]);
+    }
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#ifdef _WIN32
+        std::swap(file_handle_, other.file_handle_);
+        std::swap(mapping_handle_, other.mapping_handle_);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+//! Function used to map a file on windows
+int MappedFile::Open(const char* path, bool copy_on_write)
+{
+    Close();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return -1;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        std::cerr << "Failed to get the size of file: " << path << std::endl;
+        CloseHandle(file);
+        return -1;
+    }
+    file_handle_ = file;
+    size_ = static_cast<std::size_t>(file_size.QuadPart);
+    // Empty files cannot be mapped, they are represented by an empty mapping
+    if (size_ == 0) {
+        return 0;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        Close();
+        return -1;
+    }
+    mapping_handle_ = mapping;
+    data_ = static_cast<char*>(MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        Close();
+        return -1;
+    }
+    return 0;
+}
+
+void MappedFile::Close()
+{
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_ != nullptr) {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_ != nullptr) {
+        CloseHandle(file_handle_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    mapping_handle_ = nullptr;
+    file_handle_ = nullptr;
+}
+
+#else
+
+//! Function used to map a file on posix systems
+int MappedFile::Open(const char* path, bool copy_on_write)
+{
+    Close();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return -1;
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0) {
+        std::cerr << "Failed to get the size of file: " << path << std::endl;
+        close(fd);
+        return -1;
+    }
+    // Empty files cannot be mapped, they are represented by an empty mapping
+    if (file_stat.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    int protection = copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* data = mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), protection, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the file descriptor is closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        return -1;
+    }
+    madvise(data, static_cast<std::size_t>(file_stat.st_size), MADV_SEQUENTIAL);
+    data_ = static_cast<char*>(data);
+    size_ = static_cast<std::size_t>(file_stat.st_size);
+    return 0;
+}
+
+void MappedFile::Close()
+{
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
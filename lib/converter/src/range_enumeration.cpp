@@ -0,0 +1,178 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "range_enumeration.h"
+#include <charconv>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+// Floating point from_chars is missing in some standard libraries like the one of Apple
+#ifndef __cpp_lib_to_chars
+#include <cerrno>
+#include <cstdlib>
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#endif
+
+namespace lwm2m {
+
+namespace {
+
+//! Function used to remove the whitespace around a text
+std::string_view Trim(std::string_view text)
+{
+    constexpr std::string_view kWhitespace = " \t\r\n";
+    std::size_t begin = text.find_first_not_of(kWhitespace);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    std::size_t end = text.find_last_not_of(kWhitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+//! Function used to convert the whole text into a number
+template <typename Number>
+bool ConvertNumber(std::string_view text, Number& number)
+{
+    // Only decimal notation is accepted, so both conversions below agree on infinity, nan and hexadecimal numbers
+    if (std::is_floating_point_v<Number> and text.find_first_not_of("0123456789+-.eE") != std::string_view::npos) {
+        return false;
+    }
+#ifndef __cpp_lib_to_chars
+    if constexpr (std::is_floating_point_v<Number>) {
+        // The C locale keeps the decimal point independent of the locale of the program
+        static const locale_t c_locale = newlocale(LC_ALL_MASK, "C", nullptr);
+        std::string terminated(text);
+        char* end = nullptr;
+        errno = 0;
+        if constexpr (std::is_same_v<Number, float>) {
+            number = strtof_l(terminated.c_str(), &end, c_locale);
+        } else {
+            number = strtod_l(terminated.c_str(), &end, c_locale);
+        }
+        return errno != ERANGE and end == terminated.c_str() + terminated.size();
+    } else
+#endif
+    {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), number);
+        return result.ec == std::errc() and result.ptr == text.data() + text.size();
+    }
+}
+
+//! Function used to parse a number that has to fill the whole text
+template <typename Number>
+bool ParseNumber(std::string_view text, Number& value)
+{
+    text = Trim(text);
+    // from_chars does not accept an explicit positive sign
+    if (text.size() > 1 and text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    Number number;
+    if (text.empty() or !ConvertNumber(text, number)) {
+        return false;
+    }
+    value = number;
+    return true;
+}
+
+//! Function used to parse a range from the text before and after the separator
+bool ParseRange(std::string_view text, std::size_t separator, std::size_t separator_size,
+                RangeEnumeration& range_enumeration)
+{
+    double minimum;
+    double maximum;
+    if (!ParseNumber(text.substr(0, separator), minimum) or
+        !ParseNumber(text.substr(separator + separator_size), maximum) or minimum > maximum) {
+        return false;
+    }
+    range_enumeration.kind = RangeKind::Range;
+    range_enumeration.minimum = minimum;
+    range_enumeration.maximum = maximum;
+    return true;
+}
+
+} // namespace
+
+RangeEnumeration ParseRangeEnumeration(std::string_view text)
+{
+    RangeEnumeration range_enumeration;
+    text = Trim(text);
+    if (text.empty()) {
+        return range_enumeration;
+    }
+
+    std::size_t dots = text.find("..");
+    if (dots != std::string_view::npos) {
+        if (!ParseRange(text, dots, 2, range_enumeration)) {
+            range_enumeration.kind = RangeKind::Invalid;
+        }
+        return range_enumeration;
+    }
+
+    // A dash after the first character separates a range, unless it is the sign of an exponent
+    for (std::size_t dash = text.find('-', 1); dash != std::string_view::npos; dash = text.find('-', dash + 1)) {
+        if (text[dash - 1] != 'e' and text[dash - 1] != 'E' and ParseRange(text, dash, 1, range_enumeration)) {
+            return range_enumeration;
+        }
+    }
+
+    range_enumeration.kind = RangeKind::Enumeration;
+    while (true) {
+        std::size_t comma = text.find(',');
+        double value;
+        if (!ParseNumber(text.substr(0, comma), value)) {
+            range_enumeration.kind = RangeKind::Invalid;
+            range_enumeration.values.clear();
+            return range_enumeration;
+        }
+        range_enumeration.values.push_back(value);
+        if (comma == std::string_view::npos) {
+            return range_enumeration;
+        }
+        text.remove_prefix(comma + 1);
+    }
+}
+
+int ParseInteger(std::string_view text, int& value)
+{
+    return ParseNumber(text, value) ? 0 : -1;
+}
+
+int ParseFloat(std::string_view text, float& value)
+{
+    return ParseNumber(text, value) ? 0 : -1;
+}
+
+std::string FormatVersion(float version)
+{
+    // The classic locale keeps the decimal point independent of the locale of the program
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream << version;
+    std::string text = stream.str();
+    if (text.find_first_not_of("0123456789") == std::string::npos) {
+        text.append(".0");
+    }
+    return text;
+}
+
+}
@@ -1,3 +1,335 @@
-//
-// Created by Niklas on 07.11.2024.
-//
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <nlohmann/json.hpp>
+#include "lwm2m.h"
+#include "lwm2m_tokens.h"
+#include "mapping.h"
+#include "range_enumeration.h"
+#include "sdf_to_lwm2m.h"
+
+using json = nlohmann::ordered_json;
+
+namespace {
+
+//! Function used to get a string member, empty if there is none
+std::string GetString(const json& definition, const char* key)
+{
+    auto it = definition.find(key);
+    if (it == definition.end() or !it->is_string()) {
+        return {};
+    }
+    return it->get<std::string>();
+}
+
+//! Function used to get a boolean member, the given default if there is none
+bool GetBool(const json& definition, const char* key, bool default_value)
+{
+    auto it = definition.find(key);
+    if (it == definition.end() or !it->is_boolean()) {
+        return default_value;
+    }
+    return it->get<bool>();
+}
+
+//! Index of the sdf-mapping entries by their json pointer
+//! The entries of an ordered json can only be searched linearly, the index is built once per sdf-mapping
+class MappingIndex {
+public:
+    explicit MappingIndex(const json& map)
+    {
+        entries_.reserve(map.size());
+        for (auto it = map.begin(); it != map.end(); ++it) {
+            if (it->is_object()) {
+                entries_.emplace(it.key(), &*it);
+            }
+        }
+    }
+
+    //! Function used to get the sdf-mapping entry of a definition, nullptr if there is none
+    const json* Find(std::string_view pointer) const
+    {
+        auto it = entries_.find(pointer);
+        return it != entries_.end() ? it->second : nullptr;
+    }
+
+private:
+    // The keys point into the sdf-mapping, which outlives the index
+    std::unordered_map<std::string_view, const json*> entries_;
+};
+
+//! Resolver of the sdfRef qualities of a sdf-model
+//! Every referenced definition is resolved once, later references to it are served from the cache
+class RefResolver {
+public:
+    explicit RefResolver(const json& sdf_model) : sdf_model_(sdf_model) {}
+
+    //! Function used to apply the sdfRef of a definition
+    //! Returns the definition itself if it has no sdfRef or the reference cannot be resolved. Otherwise returns the
+    //! referenced definition, patched with the other qualities of the definition inside patched if it has any.
+    const json& Resolve(const json& definition, json& patched)
+    {
+        auto ref = definition.find("sdfRef");
+        if (ref == definition.end() or !ref->is_string()) {
+            return definition;
+        }
+        const json* target = ResolvePointer(ref->get<std::string>());
+        if (target == nullptr) {
+            return definition;
+        }
+        if (definition.size() == 1) {
+            return *target;
+        }
+        // The qualities next to sdfRef are applied as a json merge patch
+        json patch = definition;
+        patch.erase("sdfRef");
+        patched = *target;
+        patched.merge_patch(patch);
+        return patched;
+    }
+
+private:
+    //! Function used to get the resolved definition a sdfRef points to, nullptr if it cannot be resolved
+    const json* ResolvePointer(const std::string& pointer)
+    {
+        auto cached = cache_.find(pointer);
+        if (cached != cache_.end()) {
+            return cached->second;
+        }
+        // A reference back to a definition that is still being resolved closes a cycle
+        if (!in_progress_.insert(pointer).second) {
+            std::cerr << "sdfRef " << pointer << " is part of a reference cycle, ignoring it" << std::endl;
+            return nullptr;
+        }
+        const json* resolved = FindDefinition(pointer);
+        if (resolved != nullptr) {
+            json patched;
+            const json& definition = Resolve(*resolved, patched);
+            if (&definition == &patched) {
+                resolved_definitions_.push_back(std::move(patched));
+                resolved = &resolved_definitions_.back();
+            } else {
+                resolved = &definition;
+            }
+        }
+        in_progress_.erase(pointer);
+        cache_.emplace(pointer, resolved);
+        return resolved;
+    }
+
+    //! Function used to look up the definition of a sdfRef inside the sdf-model, nullptr if there is none
+    const json* FindDefinition(const std::string& pointer) const
+    {
+        if (pointer.empty() or pointer.front() != '#') {
+            std::cerr << "sdfRef " << pointer << " does not point into the sdf-model, ignoring it" << std::endl;
+            return nullptr;
+        }
+        try {
+            json::json_pointer json_pointer(pointer.substr(1));
+            if (sdf_model_.contains(json_pointer)) {
+                return &sdf_model_.at(json_pointer);
+            }
+        }
+        catch (const json::exception&) {
+        }
+        std::cerr << "sdfRef " << pointer << " could not be resolved, ignoring it" << std::endl;
+        return nullptr;
+    }
+
+    const json& sdf_model_;
+    // Unresolvable references are cached as nullptr so they are only reported once
+    std::unordered_map<std::string, const json*> cache_;
+    std::unordered_set<std::string> in_progress_;
+    // A deque keeps the patched definitions in place while it grows
+    std::deque<json> resolved_definitions_;
+};
+
+//! Function used to derive the lwm2m type of a sdfProperty without a mapping entry
+void MapDataQualities(const json& data_qualities, RefResolver& resolver, lwm2m::Resource& resource)
+{
+    const json* qualities = &data_qualities;
+    json patched_items;
+    if (GetString(data_qualities, "type") == "array" and data_qualities.contains("items")) {
+        resource.multiple_instances = true;
+        qualities = &resolver.Resolve(data_qualities.at("items"), patched_items);
+    }
+    auto minimum = qualities->find("minimum");
+    bool unsigned_integer = minimum != qualities->end() and minimum->is_number() and *minimum == 0;
+    std::string type = GetString(*qualities, "type");
+    std::string sdf_type = GetString(*qualities, "sdfType");
+    resource.type = lwm2m::MapSdfToType(type, sdf_type, unsigned_integer);
+    // Integers with a minimum of zero can also be signed integers with a range
+    if (resource.type == lwm2m::UndefinedType and unsigned_integer) {
+        resource.type = lwm2m::MapSdfToType(type, sdf_type, false);
+    }
+}
+
+//! Function used to map a sdfProperty or a sdfAction onto a resource
+//! Returns the ID of the mapping entry, negative if there is none
+int MapAffordance(const std::string& name, const json& definition, bool action, const json* mapping,
+                  bool required, RefResolver& resolver, lwm2m::Resource& resource)
+{
+    resource.name = definition.contains("label") ? GetString(definition, "label") : name;
+    resource.description = GetString(definition, "description");
+    if (!action) {
+        resource.units = GetString(definition, "unit");
+    }
+
+    if (mapping == nullptr) {
+        resource.operations = lwm2m::MapSdfToOperations(action, GetBool(definition, "readable", true),
+                                                        GetBool(definition, "writable", true));
+        resource.mandatory = required;
+        if (!action) {
+            MapDataQualities(definition, resolver, resource);
+        }
+        return -1;
+    }
+
+    resource.operations = lwm2m::DecodeOperations(GetString(*mapping, "operations"));
+    resource.type = lwm2m::DecodeType(GetString(*mapping, "type"));
+    resource.multiple_instances = GetBool(*mapping, "multipleInstances", false);
+    resource.mandatory = GetBool(*mapping, "mandatory", required);
+    resource.range_enumeration = GetString(*mapping, "rangeEnumeration");
+    resource.range = lwm2m::ParseRangeEnumeration(resource.range_enumeration);
+    auto id = mapping->find("id");
+    if (id == mapping->end() or !id->is_number_integer() or *id < 0) {
+        return -1;
+    }
+    return id->get<int>();
+}
+
+//! Function used to map a sdfObject onto a lwm2m object
+int MapSdfObject(const std::string& name, const json& sdf_object, const MappingIndex& map, RefResolver& resolver,
+                 lwm2m::Object& object)
+{
+    std::string pointer = "#/sdfObject/";
+    AppendPointerToken(name, pointer);
+    // Objects without a mapping entry or without an integer ID inside of it cannot be mapped
+    const json* mapping = map.Find(pointer);
+    const json* id = nullptr;
+    if (mapping != nullptr) {
+        auto it = mapping->find("id");
+        if (it != mapping->end() and it->is_number_integer()) {
+            id = &*it;
+        }
+    }
+    if (id == nullptr) {
+        std::cerr << "sdfObject " << name << " has no ObjectID inside the sdf-mapping, skipping" << std::endl;
+        return -1;
+    }
+
+    object.object_id = id->get<int>();
+    object.name = sdf_object.contains("label") ? GetString(sdf_object, "label") : name;
+    object.description_1 = GetString(sdf_object, "description");
+    object.description_2 = GetString(*mapping, "description2");
+    object.object_type = GetString(*mapping, "objectType");
+    object.object_urn = GetString(*mapping, "objectURN");
+    if (object.object_urn.empty()) {
+        object.object_urn = "urn:oma:lwm2m:ext:" + std::to_string(object.object_id);
+    }
+    std::string lwm2m_version = GetString(*mapping, "lwm2mVersion");
+    if (!lwm2m_version.empty() and lwm2m::ParseFloat(lwm2m_version, object.lwm2m_version) != 0) {
+        std::cerr << "Invalid lwm2mVersion \"" << lwm2m_version << "\" of sdfObject " << name << std::endl;
+    }
+    std::string object_version = GetString(*mapping, "objectVersion");
+    if (!object_version.empty() and lwm2m::ParseFloat(object_version, object.object_version) != 0) {
+        std::cerr << "Invalid objectVersion \"" << object_version << "\" of sdfObject " << name << std::endl;
+    }
+    object.multiple_instances = GetBool(*mapping, "multipleInstances", false);
+    object.mandatory = GetBool(*mapping, "mandatory", false);
+
+    std::unordered_set<std::string> required;
+    auto sdf_required = sdf_object.find("sdfRequired");
+    if (sdf_required != sdf_object.end() and sdf_required->is_array()) {
+        for (const auto& pointer : *sdf_required) {
+            if (pointer.is_string()) {
+                required.insert(pointer.get<std::string>());
+            }
+        }
+    }
+
+    // Resources without an ID are numbered once every mapped ID is known
+    std::vector<lwm2m::Resource> unnumbered;
+    int next_id = 0;
+    // The pointers of the affordances share the prefix of the object pointer, only the last token is replaced
+    const std::size_t object_pointer_size = pointer.size();
+    for (const char* affordance : {"sdfProperty", "sdfAction"}) {
+        auto definitions = sdf_object.find(affordance);
+        if (definitions == sdf_object.end() or !definitions->is_object()) {
+            continue;
+        }
+        bool action = std::string_view(affordance) == "sdfAction";
+        pointer.resize(object_pointer_size);
+        pointer.append("/").append(affordance).append("/");
+        const std::size_t affordance_pointer_size = pointer.size();
+        for (auto it = definitions->begin(); it != definitions->end(); ++it) {
+            pointer.resize(affordance_pointer_size);
+            AppendPointerToken(it.key(), pointer);
+            json patched;
+            const json& definition = resolver.Resolve(it.value(), patched);
+            lwm2m::Resource resource;
+            int resource_id = MapAffordance(it.key(), definition, action, map.Find(pointer),
+                                            required.count(pointer) != 0, resolver, resource);
+            if (resource_id < 0 or object.resources.contains(resource_id)) {
+                unnumbered.push_back(std::move(resource));
+                continue;
+            }
+            next_id = std::max(next_id, resource_id + 1);
+            object.resources[resource_id] = std::move(resource);
+        }
+    }
+    for (auto& resource : unnumbered) {
+        object.resources[next_id++] = std::move(resource);
+    }
+    return 0;
+}
+
+} // namespace
+
+//! Function used to map every sdfObject of a sdf-model onto a lwm2m object
+int MapSdfModel(const json& sdf_model_json, const json& sdf_mapping_json, std::vector<lwm2m::Object>& objects)
+{
+    auto sdf_objects = sdf_model_json.find("sdfObject");
+    if (sdf_objects == sdf_model_json.end() or !sdf_objects->is_object() or sdf_objects->empty()) {
+        std::cerr << "No sdfObject found" << std::endl;
+        return -1;
+    }
+    static const json kEmptyMap = json::object();
+    auto map = sdf_mapping_json.find("map");
+    const json& mapping_entries = map != sdf_mapping_json.end() and map->is_object() ? *map : kEmptyMap;
+    const MappingIndex index(mapping_entries);
+    // The references are resolved on demand and shared by every sdfObject of the sdf-model
+    RefResolver resolver(sdf_model_json);
+
+    int result = 0;
+    for (auto it = sdf_objects->begin(); it != sdf_objects->end(); ++it) {
+        lwm2m::Object object;
+        if (MapSdfObject(it.key(), it.value(), index, resolver, object) != 0) {
+            result = -1;
+            continue;
+        }
+        objects.push_back(std::move(object));
+    }
+    return result;
+}
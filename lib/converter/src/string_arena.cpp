@@ -0,0 +1,63 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "string_arena.h"
+#include <cstring>
+
+std::string_view StringArena::Copy(std::string_view value)
+{
+    if (value.empty()) {
+        return {};
+    }
+    if (value.size() > remaining_) {
+        // Strings larger than a block get a block of their own, so the current block stays usable
+        std::size_t size = value.size() > block_size_ / 4 ? value.size() : block_size_;
+        blocks_.emplace_back(new char[size]);
+        if (size != block_size_) {
+            std::memcpy(blocks_.back().get(), value.data(), value.size());
+            bytes_used_ += value.size();
+            return {blocks_.back().get(), value.size()};
+        }
+        current_ = blocks_.back().get();
+        remaining_ = size;
+    }
+    char* data = current_;
+    std::memcpy(data, value.data(), value.size());
+    current_ += value.size();
+    remaining_ -= value.size();
+    bytes_used_ += value.size();
+    return {data, value.size()};
+}
+
+std::string_view StringArena::Intern(std::string_view value)
+{
+    auto it = interned_.find(value);
+    if (it != interned_.end()) {
+        return *it;
+    }
+    std::string_view copy = Copy(value);
+    interned_.insert(copy);
+    return copy;
+}
+
+void StringArena::Clear()
+{
+    interned_.clear();
+    blocks_.clear();
+    current_ = nullptr;
+    remaining_ = 0;
+    bytes_used_ = 0;
+}
@@ -0,0 +1,82 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t thread_count)
+{
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; i++) {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    task_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    task_available_.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_done_.wait(lock, [this] { return tasks_.empty() and active_tasks_ == 0; });
+}
+
+//! Function executed by every worker, runs tasks until the pool is stopped and drained
+void ThreadPool::WorkerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_available_.wait(lock, [this] { return stopping_ or !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+            active_tasks_++;
+        }
+        task();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            active_tasks_--;
+            if (tasks_.empty() and active_tasks_ == 0) {
+                tasks_done_.notify_all();
+            }
+        }
+    }
+}
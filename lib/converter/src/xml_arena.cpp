@@ -0,0 +1,147 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "xml_arena.h"
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <pugixml.hpp>
+
+namespace {
+
+//! Placed in front of every allocation, so freeing knows where the memory came from
+struct alignas(16) AllocationHeader {
+    //! Owning arena, nullptr for memory of the global heap
+    XmlArena* arena;
+};
+
+constexpr std::size_t kAlignment = alignof(AllocationHeader);
+
+constexpr std::size_t AlignSize(std::size_t size)
+{
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+thread_local XmlArena* active_arena = nullptr;
+
+} // namespace
+
+void* XmlArena::Allocate(std::size_t size)
+{
+    std::size_t total = AlignSize(sizeof(AllocationHeader) + size);
+    char* memory;
+    if (total > kChunkSize / 4) {
+        large_blocks_.emplace_back(new (std::nothrow) char[total]);
+        memory = large_blocks_.back().get();
+        if (memory == nullptr) {
+            large_blocks_.pop_back();
+            return nullptr;
+        }
+        large_bytes_ += total;
+    } else {
+        if (chunks_.empty() or chunk_used_ + total > kChunkSize) {
+            // Chunks of a previous reset are reused before new ones are allocated
+            if (!chunks_.empty()) {
+                current_chunk_++;
+            }
+            if (current_chunk_ == chunks_.size()) {
+                chunks_.emplace_back(new (std::nothrow) char[kChunkSize]);
+                if (chunks_.back() == nullptr) {
+                    chunks_.pop_back();
+                    current_chunk_ = current_chunk_ > 0 ? current_chunk_ - 1 : 0;
+                    return nullptr;
+                }
+            }
+            chunk_used_ = 0;
+        }
+        memory = chunks_[current_chunk_].get() + chunk_used_;
+        chunk_used_ += total;
+    }
+    auto* header = new (memory) AllocationHeader{this};
+    live_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
+}
+
+int XmlArena::Reset()
+{
+    if (live_allocations_.load(std::memory_order_acquire) != 0) {
+        return -1;
+    }
+    large_blocks_.clear();
+    large_bytes_ = 0;
+    current_chunk_ = 0;
+    chunk_used_ = 0;
+    return 0;
+}
+
+std::size_t XmlArena::BytesReserved() const
+{
+    return chunks_.size() * kChunkSize + large_bytes_;
+}
+
+void* XmlArenaAllocate(std::size_t size)
+{
+    if (active_arena != nullptr) {
+        return active_arena->Allocate(size);
+    }
+    void* memory = std::malloc(sizeof(AllocationHeader) + size);
+    if (memory == nullptr) {
+        return nullptr;
+    }
+    auto* header = new (memory) AllocationHeader{nullptr};
+    return header + 1;
+}
+
+void XmlArenaDeallocate(void* memory)
+{
+    if (memory == nullptr) {
+        return;
+    }
+    AllocationHeader* header = static_cast<AllocationHeader*>(memory) - 1;
+    if (header->arena != nullptr) {
+        header->arena->live_allocations_.fetch_sub(1, std::memory_order_release);
+    } else {
+        std::free(header);
+    }
+}
+
+void InstallXmlArena()
+{
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        pugi::set_memory_management_functions(XmlArenaAllocate, XmlArenaDeallocate);
+    });
+}
+
+XmlArena& ThreadXmlArena()
+{
+    thread_local XmlArena arena;
+    return arena;
+}
+
+XmlArenaScope::XmlArenaScope(XmlArena& arena) : arena_(arena), previous_(active_arena)
+{
+    active_arena = &arena_;
+}
+
+XmlArenaScope::~XmlArenaScope()
+{
+    active_arena = previous_;
+    // Nested scopes of the same arena leave the reset to the outermost one
+    if (previous_ != &arena_) {
+        arena_.Reset();
+    }
+}
@@ -0,0 +1,40 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "xml_files.h"
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+std::vector<fs::path> CollectXmlFiles(const fs::path& directory)
+{
+    std::vector<std::pair<std::string, fs::path>> entries;
+    for (const auto& dir_entry : fs::recursive_directory_iterator(directory)) {
+        if (dir_entry.is_regular_file() and dir_entry.path().extension() == ".xml") {
+            entries.emplace_back(dir_entry.path().lexically_relative(directory).generic_string(), dir_entry.path());
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    std::vector<fs::path> files;
+    files.reserve(entries.size());
+    for (auto& entry : entries) {
+        files.push_back(std::move(entry.second));
+    }
+    return files;
+}
@@ -26,6 +26,13 @@
 #ifndef SDF_LWM2M_CONVERTER_LIB_VALIDATOR_INCLUDE_VALIDATOR_H_
 #define SDF_LWM2M_CONVERTER_LIB_VALIDATOR_INCLUDE_VALIDATOR_H_
 
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <nlohmann/json-schema.hpp>
+
+struct _xmlSchema;
+struct _xmlDoc;
+
 //! @brief Check compliance for sdf file against schema_path.
 //!
 //! This function checks, if a given file complies with the given schema_path.
@@ -44,4 +51,80 @@ int ValidateSdf(const char* path, const char* schema_path);
 //! @return 0 on success, negative on failure.
 int ValidateLwm2m(const char* path, const char* schema_path);
 
+//! @brief Validator for sdf files against a precompiled json schema.
+//!
+//! The schema is loaded and compiled once by LoadSchema and reused for every
+//! following validation. Validate can be called from multiple threads at the
+//! same time, as validating does not modify the compiled schema.
+class SdfValidator {
+public:
+    //! @brief Load and compile the json schema.
+    //!
+    //! @param schema_path Path to the schema file.
+    //! @return 0 on success, negative on failure.
+    int LoadSchema(const char* schema_path);
+
+    //! @brief Check compliance for sdf file against the loaded schema.
+    //!
+    //! @param path Path to the file.
+    //! @return 0 on success, negative on failure.
+    int Validate(const char* path) const;
+
+    //! @brief Check compliance for a sdf json object against the loaded schema.
+    //!
+    //! This allows validating outputs without writing them to disk first.
+    //!
+    //! @param json_file The json object.
+    //! @return 0 on success, negative on failure.
+    int Validate(const nlohmann::ordered_json& json_file) const;
+
+private:
+    nlohmann::json_schema::json_validator validator_;
+    bool loaded_ = false;
+};
+
+//! @brief Validator for lwm2m files against a precompiled xsd schema.
+//!
+//! The schema is parsed once by LoadSchema and reused for every following
+//! validation. Validate can be called from multiple threads at the same time,
+//! as every call uses its own validation context on the shared schema.
+class Lwm2mValidator {
+public:
+    Lwm2mValidator() = default;
+    ~Lwm2mValidator();
+
+    Lwm2mValidator(const Lwm2mValidator&) = delete;
+    Lwm2mValidator& operator=(const Lwm2mValidator&) = delete;
+
+    //! @brief Load and compile the xsd schema.
+    //!
+    //! Has to be called before the validator is shared between threads.
+    //!
+    //! @param schema_path Path to the schema file.
+    //! @return 0 on success, negative on failure.
+    int LoadSchema(const char* schema_path);
+
+    //! @brief Check compliance for lwm2m file against the loaded schema.
+    //!
+    //! @param path Path to the file.
+    //! @return 0 on success, negative on failure, positive if the file is not valid.
+    int Validate(const char* path) const;
+
+    //! @brief Check compliance for a serialized lwm2m file against the loaded schema.
+    //!
+    //! This allows validating outputs from the buffer they were written from
+    //! instead of reading them back from disk.
+    //!
+    //! @param buffer The serialized xml.
+    //! @param size The size of the buffer in bytes.
+    //! @return 0 on success, negative on failure, positive if the file is not valid.
+    int ValidateMemory(const char* buffer, std::size_t size) const;
+
+private:
+    //! Validate a parsed libxml2 document and free it afterwards
+    int ValidateDoc(_xmlDoc* doc) const;
+
+    _xmlSchema* schema_ = nullptr;
+};
+
 #endif //SDF_LWM2M_CONVERTER_LIB_VALIDATOR_INCLUDE_VALIDATOR_H_
@@ -19,6 +19,7 @@
 #include <libxml/xmlschemas.h>
 #include <fstream>
 #include <iostream>
+#include "validator.h"
 
 using nlohmann::ordered_json;
 using nlohmann::json_schema::json_validator;
@@ -38,27 +39,44 @@ int LoadJsonFile(const char* path, nlohmann::ordered_json& json_file)
     return 0;
 }
 
-//! Function used to validate a json file against a json schema
-int ValidateSdf(const char* path, const char* schema_path)
+//! Function used to load and compile the json schema once for all following validations
+int SdfValidator::LoadSchema(const char* schema_path)
 {
-    //Load the json file as well as the schema_path
-    nlohmann::ordered_json json_file;
-    LoadJsonFile(path, json_file);
     nlohmann::ordered_json json_schema;
-    LoadJsonFile(schema_path, json_schema);
+    if (LoadJsonFile(schema_path, json_schema) != 0) {
+        return -1;
+    }
 
-    // Create a new validator and set its schema_path
-    json_validator validator;
     try {
-        validator.set_root_schema(json_schema);
+        validator_.set_root_schema(json_schema);
     } catch (const std::exception &e) {
         std::cerr << "Validation of schema_path failed: " << e.what() << "\n";
         return -1;
     }
+    loaded_ = true;
+    return 0;
+}
+
+//! Function used to validate a json file against the compiled json schema
+int SdfValidator::Validate(const char* path) const
+{
+    nlohmann::ordered_json json_file;
+    if (LoadJsonFile(path, json_file) != 0) {
+        return -1;
+    }
+    return Validate(json_file);
+}
+
+//! Function used to validate a json object against the compiled json schema
+int SdfValidator::Validate(const ordered_json& json_file) const
+{
+    if (!loaded_) {
+        std::cerr << "No JSON Schema loaded" << std::endl;
+        return -1;
+    }
 
-    // Validate the json file against the schema_path
     try {
-        auto default_patch = validator.validate(json_file);
+        auto default_patch = validator_.validate(json_file);
     } catch (const std::exception &e) {
         std::cerr << "Validation of schema_path failed: " << e.what() << "\n";
         return -1;
@@ -66,57 +84,115 @@ int ValidateSdf(const char* path, const char* schema_path)
     return 0;
 }
 
-//! Function used to validate a xml file against a xsd schema
-int ValidateLwm2m(const char* path, const char* schema_path) {
-    // Try to load the xml file
-    xmlDocPtr doc = xmlReadFile(path, NULL, 0);
-    if (doc == nullptr) {
-        std::cerr << "Failed to parse " << path << std::endl;
-        return false;
+//! Function used to validate a json file against a json schema
+int ValidateSdf(const char* path, const char* schema_path)
+{
+    SdfValidator validator;
+    if (validator.LoadSchema(schema_path) != 0) {
+        return -1;
+    }
+    return validator.Validate(path);
+}
+
+Lwm2mValidator::~Lwm2mValidator()
+{
+    if (schema_ != nullptr) {
+        xmlSchemaFree(schema_);
     }
+}
+
+//! Function used to parse the xsd schema once for all following validations
+int Lwm2mValidator::LoadSchema(const char* schema_path)
+{
+    // Initialize the library on the calling thread, as required before libxml2 is used by multiple threads
+    xmlInitParser();
 
     // Create a new schema parser context from the xsd schema file
     xmlSchemaParserCtxtPtr parser_ctxt = xmlSchemaNewParserCtxt(schema_path);
     if (parser_ctxt == nullptr) {
         std::cerr << "Could not create XML Schema parser context for " << schema_path << std::endl;
-        xmlFreeDoc(doc);
-        return false;
+        return -1;
     }
 
     // Create a new schema from the schema parser context
     xmlSchemaPtr schema = xmlSchemaParse(parser_ctxt);
+    xmlSchemaFreeParserCtxt(parser_ctxt);
     if (schema == nullptr) {
-        std::cerr << "Failed to parse XML Schema " << schema << std::endl;
-        xmlSchemaFreeParserCtxt(parser_ctxt);
-        xmlFreeDoc(doc);
-        return false;
+        std::cerr << "Failed to parse XML Schema " << schema_path << std::endl;
+        return -1;
+    }
+
+    if (schema_ != nullptr) {
+        xmlSchemaFree(schema_);
+    }
+    schema_ = schema;
+    return 0;
+}
+
+//! Function used to validate a xml file against the compiled xsd schema
+int Lwm2mValidator::Validate(const char* path) const
+{
+    if (schema_ == nullptr) {
+        std::cerr << "No XML Schema loaded" << std::endl;
+        return -1;
+    }
+
+    // Try to load the xml file
+    xmlDocPtr doc = xmlReadFile(path, NULL, 0);
+    if (doc == nullptr) {
+        std::cerr << "Failed to parse " << path << std::endl;
+        return -1;
+    }
+    return ValidateDoc(doc);
+}
+
+//! Function used to validate a serialized xml file against the compiled xsd schema
+int Lwm2mValidator::ValidateMemory(const char* buffer, std::size_t size) const
+{
+    if (schema_ == nullptr) {
+        std::cerr << "No XML Schema loaded" << std::endl;
+        return -1;
     }
 
-    // Create a new schema validation context
-    xmlSchemaValidCtxtPtr valid_ctxt = xmlSchemaNewValidCtxt(schema);
+    // Parse the xml directly from the buffer it was serialized into
+    xmlDocPtr doc = xmlReadMemory(buffer, static_cast<int>(size), NULL, NULL, 0);
+    if (doc == nullptr) {
+        std::cerr << "Failed to parse XML buffer" << std::endl;
+        return -1;
+    }
+    return ValidateDoc(doc);
+}
+
+//! Function used to validate a parsed xml document against the compiled xsd schema
+int Lwm2mValidator::ValidateDoc(xmlDocPtr doc) const
+{
+    // Validation contexts are not thread safe, so every validation gets its own one
+    xmlSchemaValidCtxtPtr valid_ctxt = xmlSchemaNewValidCtxt(schema_);
     if (valid_ctxt == nullptr) {
         std::cerr << "Could not create XML Schema validation context" << std::endl;
-        xmlSchemaFree(schema);
-        xmlSchemaFreeParserCtxt(parser_ctxt);
         xmlFreeDoc(doc);
-        return false;
+        return -1;
     }
 
     // Validate the file against the schema using the validation context
+    // The verdict is only reported through the return value, callers print their own
     int ret = xmlSchemaValidateDoc(valid_ctxt, doc);
-    if (ret == 0) {
-        std::cout << "The XML file is valid against the schema." << std::endl;
-    } else if (ret > 0) {
-        std::cout << "The XML file is NOT valid against the schema." << std::endl;
-    } else {
+    if (ret < 0) {
         std::cerr << "Validation generated an internal error." << std::endl;
     }
 
     // Cleanup
     xmlSchemaFreeValidCtxt(valid_ctxt);
-    xmlSchemaFree(schema);
-    xmlSchemaFreeParserCtxt(parser_ctxt);
     xmlFreeDoc(doc);
 
     return ret;
 }
+
+//! Function used to validate a xml file against a xsd schema
+int ValidateLwm2m(const char* path, const char* schema_path) {
+    Lwm2mValidator validator;
+    if (validator.LoadSchema(schema_path) != 0) {
+        return -1;
+    }
+    return validator.Validate(path);
+}
@@ -0,0 +1,448 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <pugixml.hpp>
+#include <bounded_queue.h>
+#include <content_hash.h>
+#include <converter.h>
+#include <mapped_file.h>
+#include <thread_pool.h>
+#include <xml_arena.h>
+#include <xml_files.h>
+#include "batch.h"
+#include "main.h"
+#include "stats.h"
+
+using json = nlohmann::ordered_json;
+namespace fs = std::filesystem;
+
+namespace {
+
+//! Name of the manifest kept inside the output directory by incremental conversions
+const char* const kManifestFilename = ".sdf-lwm2m-manifest.json";
+
+//! State of a converted file recorded inside the manifest
+struct ManifestEntry {
+    std::string content_hash;
+    //! Outputs relative to the output directory
+    std::vector<std::string> outputs;
+};
+
+//! Outcome of the conversion of a single file
+struct BatchResult {
+    int status = 0;
+    std::string message;
+    //! The outputs of the previous run were kept
+    bool up_to_date = false;
+    ManifestEntry manifest_entry;
+};
+
+//! Function used to format a content hash for the manifest
+std::string FormatHash(std::uint64_t hash)
+{
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return stream.str();
+}
+
+//! Function used to hash everything besides the inputs that influences the outputs
+std::string HashConfiguration(const BatchOptions& options)
+{
+    std::uint64_t hash = HashContent(kConverterVersion);
+    // The indentation and the format change every output, so it is part of the configuration as well
+    std::string output_settings = std::to_string(options.indent) + SdfFormatExtension(options.format);
+    hash = HashContent(output_settings, hash);
+    if (!options.validation_schema.empty()) {
+        MappedFile schema;
+        if (schema.Open(options.validation_schema.c_str()) == 0) {
+            hash = HashContent(schema.Data(), schema.Size(), hash);
+        }
+    }
+    return FormatHash(hash);
+}
+
+//! Function used to load the entries of the previous run, nothing is loaded if the configuration changed
+std::unordered_map<std::string, ManifestEntry> LoadManifest(const fs::path& path, const std::string& configuration)
+{
+    std::unordered_map<std::string, ManifestEntry> entries;
+    std::error_code error_code;
+    if (!fs::exists(path, error_code)) {
+        return entries;
+    }
+    json manifest;
+    if (LoadJsonFile(path.string().c_str(), manifest) != 0) {
+        return entries;
+    }
+    try {
+        if (manifest.at("converterVersion") != kConverterVersion or manifest.at("configuration") != configuration) {
+            std::cout << "Converter or validation schema changed, converting every Cluster XML" << std::endl;
+            return entries;
+        }
+        for (const auto& [input, file] : manifest.at("files").items()) {
+            ManifestEntry& entry = entries[input];
+            entry.content_hash = file.at("contentHash").get<std::string>();
+            entry.outputs = file.at("outputs").get<std::vector<std::string>>();
+        }
+    }
+    catch (const std::exception& err) {
+        std::cerr << "Ignoring invalid manifest: " << path.string() << std::endl;
+        std::cerr << err.what() << std::endl;
+        entries.clear();
+    }
+    return entries;
+}
+
+//! Function used to check if the outputs of a previous run can be kept
+bool IsUpToDate(const ManifestEntry* previous, const std::string& content_hash, const BatchOptions& options)
+{
+    if (previous == nullptr or previous->content_hash != content_hash) {
+        return false;
+    }
+    std::error_code error_code;
+    for (const auto& output : previous->outputs) {
+        if (!fs::is_regular_file(fs::path(options.output_directory) / output, error_code)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! File handed from the reader stage to the converter stage
+struct LoadedFile {
+    std::size_t index = 0;
+    MappedFile file;
+};
+
+//! Result of the converter stage handed to the writer stage
+struct ConvertedFile {
+    std::size_t index = 0;
+    json sdf_model;
+    json sdf_mapping;
+    //! Reason why the outputs are not valid, empty if they are valid or were not validated
+    std::string validation_failure;
+};
+
+//! Function used by the reader stage to load an object xml ahead of its conversion
+//! Returns true if the file has to be converted, false if it failed or is up to date
+bool LoadFile(const fs::path& input, const BatchOptions& options, const ManifestEntry* previous, LoadedFile& loaded,
+              BatchResult& result)
+{
+    const std::string input_path = input.string();
+    StageTimer load_timer(options.stats, Stage::Load, input_path);
+    if (loaded.file.Open(input_path.c_str(), true) != 0) {
+        result = Failure<BatchResult>("Failed to load");
+        return false;
+    }
+    load_timer.AddBytesRead(loaded.file.Size());
+
+    // The content is hashed before it gets modified by parsing it in place, hashing reads every page as well
+    if (options.incremental) {
+        result.manifest_entry.content_hash = FormatHash(HashContent(loaded.file.Data(), loaded.file.Size()));
+        if (IsUpToDate(previous, result.manifest_entry.content_hash, options)) {
+            result.up_to_date = true;
+            result.manifest_entry.outputs = previous->outputs;
+            return false;
+        }
+    } else {
+        loaded.file.Prefetch();
+    }
+    return true;
+}
+
+//! Function used by the converter stage to parse, convert and validate a loaded object xml
+int ConvertLoadedFile(const fs::path& input, LoadedFile& loaded, const BatchOptions& options,
+                      const SdfValidator* sdf_validator, ConvertedFile& converted, BatchResult& result)
+{
+    const std::string input_path = input.string();
+    // The document pages come from the arena of the worker, which is reset once the document is gone
+    XmlArenaScope arena_scope(ThreadXmlArena());
+    MappedXmlDocument lwm2m_xml;
+    lwm2m_xml.file = std::move(loaded.file);
+
+    StageTimer parse_timer(options.stats, Stage::Parse, input_path);
+    if (ParseMappedXmlFile(input_path.c_str(), lwm2m_xml) != 0) {
+        result = Failure<BatchResult>("Failed to load");
+        return -1;
+    }
+    parse_timer.Stop();
+
+    StageTimer convert_timer(options.stats, Stage::Convert, input_path);
+    converted.index = loaded.index;
+    if (ConvertLwm2mToSdf(lwm2m_xml.document, converted.sdf_model, converted.sdf_mapping) != 0) {
+        result = Failure<BatchResult>("Failed to convert");
+        return -1;
+    }
+    convert_timer.Stop();
+
+    // Invalid outputs are still written, but the file counts as failed
+    if (sdf_validator != nullptr) {
+        StageTimer validate_timer(options.stats, Stage::Validate, input_path);
+        if (sdf_validator->Validate(converted.sdf_model) != 0) {
+            converted.validation_failure = "SDF-model not valid";
+        } else if (sdf_validator->Validate(converted.sdf_mapping) != 0) {
+            converted.validation_failure = "SDF-mapping not valid";
+        }
+    }
+    return 0;
+}
+
+//! Function used by the writer stage to save the sdf-model and sdf-mapping of a converted object xml
+void WriteConvertedFile(const fs::path& input, const ConvertedFile& converted, const BatchOptions& options,
+                        BatchResult& result)
+{
+    const std::string input_path = input.string();
+    // Mirror the input directory structure inside the output directory
+    fs::path output = fs::path(options.output_directory) / input.lexically_relative(options.input_directory);
+    output.replace_extension(SdfFormatExtension(options.format));
+    std::error_code error_code;
+    fs::create_directories(output.parent_path(), error_code);
+    if (error_code) {
+        result = Failure<BatchResult>("Failed to create " + output.parent_path().string() + ": " + error_code.message());
+        return;
+    }
+
+    std::string path_sdf_model;
+    std::string path_sdf_mapping;
+    GenerateSdfFilenames(output.string(), options.format, path_sdf_model, path_sdf_mapping);
+
+    // The json is serialized while it is written, so both are measured as the write
+    StageTimer write_timer(options.stats, Stage::Write, input_path);
+    std::uint64_t sdf_model_bytes = 0;
+    std::uint64_t sdf_mapping_bytes = 0;
+    if (SaveSdfFile(path_sdf_model.c_str(), converted.sdf_model, options.format, options.indent,
+                    &sdf_model_bytes) != 0) {
+        result = Failure<BatchResult>("Failed to save " + path_sdf_model);
+        return;
+    }
+    if (SaveSdfFile(path_sdf_mapping.c_str(), converted.sdf_mapping, options.format, options.indent,
+                    &sdf_mapping_bytes) != 0) {
+        result = Failure<BatchResult>("Failed to save " + path_sdf_mapping);
+        return;
+    }
+    write_timer.AddBytesWritten(sdf_model_bytes + sdf_mapping_bytes);
+    write_timer.Stop();
+
+    if (!converted.validation_failure.empty()) {
+        result = Failure<BatchResult>(converted.validation_failure);
+        return;
+    }
+    for (const auto& path : {path_sdf_model, path_sdf_mapping}) {
+        result.manifest_entry.outputs.push_back(
+                fs::path(path).lexically_relative(options.output_directory).generic_string());
+    }
+}
+
+//! Function used to run every file through the reader, converter and writer stages
+void RunPipeline(const std::vector<fs::path>& files, const std::vector<const ManifestEntry*>& previous_entries,
+                 const BatchOptions& options, const SdfValidator* sdf_validator, std::vector<BatchResult>& results)
+{
+    ThreadPool converters(options.jobs);
+    ThreadPool readers(options.io_threads);
+    ThreadPool writers(options.io_threads);
+    std::cout << "Converting " << files.size() << " Cluster XML using " << converters.Size() << " threads and "
+              << readers.Size() << " I/O threads per direction" << std::endl;
+
+    // The queues bound how far the readers can run ahead of the converters and the converters ahead of the
+    // writers, so only a few mapped inputs and converted outputs are kept in memory at a time
+    BoundedQueue<LoadedFile> loaded_files(2 * converters.Size());
+    BoundedQueue<ConvertedFile> converted_files(2 * converters.Size());
+    std::atomic<std::size_t> next_file{0};
+    std::atomic<std::size_t> active_readers{readers.Size()};
+    std::atomic<std::size_t> active_converters{converters.Size()};
+
+    // Every stage only writes into the result slot of the file it currently holds
+    for (std::size_t reader = 0; reader < readers.Size(); reader++) {
+        readers.Submit([&] {
+            for (std::size_t i = next_file++; i < files.size(); i = next_file++) {
+                try {
+                    LoadedFile loaded;
+                    loaded.index = i;
+                    if (LoadFile(files[i], options, previous_entries[i], loaded, results[i])) {
+                        loaded_files.Push(std::move(loaded));
+                    }
+                }
+                catch (const std::exception& err) {
+                    results[i] = Failure<BatchResult>(err.what());
+                }
+            }
+            // The last reader tells the converters that no further files follow
+            if (--active_readers == 0) {
+                loaded_files.Close();
+            }
+        });
+    }
+    for (std::size_t converter = 0; converter < converters.Size(); converter++) {
+        converters.Submit([&] {
+            LoadedFile loaded;
+            while (loaded_files.Pop(loaded)) {
+                std::size_t i = loaded.index;
+                try {
+                    ConvertedFile converted;
+                    if (ConvertLoadedFile(files[i], loaded, options, sdf_validator, converted, results[i]) == 0) {
+                        converted_files.Push(std::move(converted));
+                    }
+                }
+                catch (const std::exception& err) {
+                    results[i] = Failure<BatchResult>(err.what());
+                }
+            }
+            if (--active_converters == 0) {
+                converted_files.Close();
+            }
+        });
+    }
+    for (std::size_t writer = 0; writer < writers.Size(); writer++) {
+        writers.Submit([&] {
+            ConvertedFile converted;
+            while (converted_files.Pop(converted)) {
+                std::size_t i = converted.index;
+                try {
+                    WriteConvertedFile(files[i], converted, options, results[i]);
+                }
+                catch (const std::exception& err) {
+                    results[i] = Failure<BatchResult>(err.what());
+                }
+            }
+        });
+    }
+    readers.Wait();
+    converters.Wait();
+    writers.Wait();
+}
+
+//! Function used to save the manifest and to delete the outputs of inputs that no longer exist
+int SaveManifest(const fs::path& path, const std::string& configuration, const std::vector<fs::path>& files,
+                 const std::vector<BatchResult>& results,
+                 const std::unordered_map<std::string, ManifestEntry>& previous_entries, const BatchOptions& options)
+{
+    json manifest;
+    manifest["converterVersion"] = kConverterVersion;
+    manifest["configuration"] = configuration;
+    json& manifest_files = manifest["files"];
+    manifest_files = json::object();
+    std::unordered_set<std::string> inputs;
+    std::unordered_set<std::string> outputs;
+    for (std::size_t i = 0; i < files.size(); i++) {
+        std::string input = files[i].lexically_relative(options.input_directory).generic_string();
+        inputs.insert(input);
+        // Failed files are left out, so they are converted again by the next run
+        if (results[i].status != 0) {
+            continue;
+        }
+        manifest_files[input]["contentHash"] = results[i].manifest_entry.content_hash;
+        manifest_files[input]["outputs"] = results[i].manifest_entry.outputs;
+        outputs.insert(results[i].manifest_entry.outputs.begin(), results[i].manifest_entry.outputs.end());
+    }
+
+    for (const auto& [input, entry] : previous_entries) {
+        if (inputs.count(input) != 0) {
+            continue;
+        }
+        for (const auto& output : entry.outputs) {
+            if (outputs.count(output) == 0) {
+                std::error_code error_code;
+                fs::remove(fs::path(options.output_directory) / output, error_code);
+            }
+        }
+    }
+
+    std::error_code error_code;
+    fs::create_directories(path.parent_path(), error_code);
+    return SaveJsonFile(path.string().c_str(), manifest);
+}
+
+} // namespace
+
+//! Function used to convert every object xml of a directory in parallel
+int ConvertLwm2mDirectory(const BatchOptions& options)
+{
+    std::vector<fs::path> files;
+    try {
+        files = CollectXmlFiles(options.input_directory);
+    }
+    catch (const std::exception& err) {
+        std::cerr << "Failed to read directory: " << options.input_directory << std::endl;
+        std::cerr << err.what() << std::endl;
+        return -1;
+    }
+
+    // The manifest of the previous run decides which files are already up to date
+    fs::path manifest_path = fs::path(options.output_directory) / kManifestFilename;
+    std::string configuration;
+    std::unordered_map<std::string, ManifestEntry> previous_entries;
+    if (options.incremental) {
+        configuration = HashConfiguration(options);
+        previous_entries = LoadManifest(manifest_path, configuration);
+    }
+
+    // The schema is compiled once and shared by every worker
+    SdfValidator sdf_validator;
+    const SdfValidator* shared_validator = nullptr;
+    if (!options.validation_schema.empty()) {
+        if (sdf_validator.LoadSchema(options.validation_schema.c_str()) != 0) {
+            std::cerr << "Failed to load the validation schema" << std::endl;
+            return -1;
+        }
+        shared_validator = &sdf_validator;
+    }
+
+    // Lookups only read the map, so the stages can share it
+    std::vector<const ManifestEntry*> previous(files.size(), nullptr);
+    for (std::size_t i = 0; i < files.size(); i++) {
+        auto it = previous_entries.find(files[i].lexically_relative(options.input_directory).generic_string());
+        if (it != previous_entries.end()) {
+            previous[i] = &it->second;
+        }
+    }
+
+    std::vector<BatchResult> results(files.size());
+    RunPipeline(files, previous, options, shared_validator, results);
+
+    // Report the failures in path order so the output is independent of the scheduling
+    std::size_t failed = 0;
+    std::size_t up_to_date = 0;
+    for (std::size_t i = 0; i < files.size(); i++) {
+        if (results[i].status != 0) {
+            std::cerr << files[i].string() << ": " << results[i].message << std::endl;
+            failed++;
+        } else if (results[i].up_to_date) {
+            up_to_date++;
+        }
+    }
+    std::cout << "Successfully converted " << files.size() - failed << " of " << files.size()
+              << " Cluster XML!" << std::endl;
+
+    if (options.incremental) {
+        std::cout << up_to_date << " Cluster XML were already up to date" << std::endl;
+        if (SaveManifest(manifest_path, configuration, files, results, previous_entries, options) != 0) {
+            std::cerr << "Failed to save the manifest" << std::endl;
+            return -1;
+        }
+    }
+    return failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,77 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Functions to convert a whole directory of lwm2m objects in parallel.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_SRC_BATCH_H_
+#define SDF_LWM2M_CONVERTER_SRC_BATCH_H_
+
+#include <cstddef>
+#include <string>
+#include "main.h"
+#include "stats.h"
+
+//! Options for the conversion of a directory of lwm2m objects
+struct BatchOptions {
+    //! Directory which gets searched recursively for object xml files
+    std::string input_directory;
+    //! Directory which receives the sdf-model and sdf-mapping of every object
+    std::string output_directory;
+    //! Number of worker threads, 0 selects the hardware concurrency
+    std::size_t jobs = 0;
+    //! Number of threads reading the inputs and of threads writing the outputs, 0 selects the hardware concurrency
+    std::size_t io_threads = 2;
+    //! Path to the schema used for validation, empty if the outputs should not be validated
+    std::string validation_schema;
+    //! Skip files whose content, converter version and validation schema did not change since the last run
+    bool incremental = false;
+    //! Indentation of the saved json files, negative for compact json
+    int indent = 4;
+    //! Format of the saved sdf-model and sdf-mapping files
+    SdfFormat format = SdfFormat::Json;
+    //! Receives the measurements of every stage of every file, nullptr if nothing should be measured
+    Stats* stats = nullptr;
+};
+
+//! @brief Convert every lwm2m object xml of a directory into sdf.
+//!
+//! The files run through a pipeline of three stages connected by bounded
+//! queues. Reader threads map and prefetch the files ahead of their use,
+//! a pool of worker threads parses, converts and validates them and writer
+//! threads save the results, so reading, converting and writing overlap.
+//! The outputs are placed at the same relative path inside the output
+//! directory, so the result does not depend on the scheduling.
+//! Failures are collected per file and reported in path order once every file
+//! has been processed.
+//!
+//! In incremental mode a manifest with the content hash and the outputs of
+//! every converted file is kept inside the output directory. Files are only
+//! converted again if their content, the converter version or the validation
+//! schema changed or one of their outputs is missing. Outputs of files that
+//! were removed from the input directory get deleted.
+//!
+//! @param options The options of the batch conversion.
+//! @return 0 on success, negative if at least one file failed.
+int ConvertLwm2mDirectory(const BatchOptions& options);
+
+#endif //SDF_LWM2M_CONVERTER_SRC_BATCH_H_
@@ -17,45 +17,80 @@
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <optional>
+#include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include <pugixml.hpp>
 #include <argparse/argparse.hpp>
 #include <converter.h>
+#include <lwm2m_index.h>
+#include <xml_arena.h>
+#include "batch.h"
+#include "server.h"
+#include "stats.h"
+#include "verify.h"
 #include "main.h"
 
 using json = nlohmann::ordered_json;
 using recursive_directory_iterator = std::filesystem::recursive_directory_iterator;
 
-//! Helper function that generates sdf-model and sdf-mapping filenames
-//! Generates filenames of the format "path/to/file[-model|-mapping].json"
-void GenerateSdfFilenames(const std::string& input, std::string& sdf_model_name, std::string& sdf_mapping_name){
-    auto last_dot = input.find_last_of('.');
-
-    sdf_model_name.append(input.substr(0, last_dot));
-    sdf_model_name.append("-model");
-    sdf_model_name.append(input.substr(last_dot));
-
-    sdf_mapping_name.append(input.substr(0, last_dot));
-    sdf_mapping_name.append("-mapping");
-    sdf_mapping_name.append(input.substr(last_dot));
+//! Function used to save a sdf file while measuring it, the json is serialized while it is written
+static int SaveMeasuredSdfFile(const std::string& path, const json& json_file, SdfFormat format, int indent,
+                               Stats* stats)
+{
+    StageTimer write_timer(stats, Stage::Write, path);
+    std::uint64_t bytes_written = 0;
+    int result = SaveSdfFile(path.c_str(), json_file, format, indent, &bytes_written);
+    write_timer.AddBytesWritten(bytes_written);
+    return result;
 }
 
-//! Helper function that generates device and cluster filenames
-//! Generates filenames of the format "path/to/file[-device|-cluster].xml"
-void GenerateLwm2mFilenames(const std::string& input, std::string& device_xml_name, std::string& cluster_xml_name){
-    auto last_dot = input.find_last_of('.');
-
-    device_xml_name.append(input.substr(0, last_dot));
-    device_xml_name.append("-device");
-    device_xml_name.append(input.substr(last_dot));
+//! Function used to save lwm2m objects into a Cluster XML while measuring it, the xml is validated if a validator is given
+static int SaveMeasuredLwm2mFile(const std::string& path, const std::vector<lwm2m::Object>& objects,
+                                 Lwm2mValidator* validator, Stats* stats)
+{
+    StageTimer write_timer(stats, Stage::Write, path);
+    // Without validation the xml is written straight into the file
+    if (validator == nullptr) {
+        std::uint64_t bytes_written = 0;
+        int result = SaveLwm2mFile(path.c_str(), objects, &bytes_written);
+        write_timer.AddBytesWritten(bytes_written);
+        return result;
+    }
+    std::string xml_buffer;
+    if (SaveLwm2mFile(path.c_str(), objects, xml_buffer) != 0) {
+        return -1;
+    }
+    write_timer.AddBytesWritten(xml_buffer.size());
+    write_timer.Stop();
+
+    StageTimer validate_timer(stats, Stage::Validate, path);
+    if (validator->ValidateMemory(xml_buffer.data(), xml_buffer.size()) == 0) {
+        std::cout << "Cluster XML " << path << " valid!..." << std::endl;
+    } else {
+        std::cout << "Cluster XML " << path << " not valid!..." << std::endl;
+    }
+    return 0;
+}
 
-    cluster_xml_name.append(input.substr(0, last_dot));
-    cluster_xml_name.append("-cluster");
-    cluster_xml_name.append(input.substr(last_dot));
+//! Function used to load a sdf file in any format while measuring it
+static int LoadMeasuredSdfFile(const std::string& path, json& json_file, Stats* stats)
+{
+    StageTimer load_timer(stats, Stage::Load, path);
+    std::error_code error_code;
+    auto size = std::filesystem::file_size(path, error_code);
+    if (!error_code) {
+        load_timer.AddBytesRead(size);
+    }
+    return LoadSdfFile(path.c_str(), json_file);
 }
 
 //! Main function
 int main(int argc, char *argv[]) {
+    // Xml documents allocate from per thread arenas wherever an arena scope is active
+    InstallXmlArena();
+
     // Define the program name
     argparse::ArgumentParser program("sdf-lwm2m-converter");
 
@@ -86,15 +121,67 @@ int main(int argc, char *argv[]) {
         .help("Path to a input XML containing a Cluster definition\n"
               "Used without a Device Type definition to create a Model with a single sdf_object");
 
+    program.add_argument("--jobs")
+        .help("Convert every Cluster XML inside the -cluster-xml folder in parallel using the given number of threads\n"
+              "Each Cluster XML is converted on its own into the -output folder, 0 uses every available core\n"
+              "If -cluster-xml is a single file, its objects are converted in parallel into one SDF model")
+        .scan<'i', int>();
+
+    program.add_argument("--io-threads")
+        .help("Number of threads reading the Cluster XML and of threads writing the SDF files with --jobs\n"
+              "Reading, converting and writing overlap, more I/O threads hide the latency of slow or remote storage")
+        .default_value(2)
+        .scan<'i', int>();
+
+    program.add_argument("--incremental")
+        .help("Only convert the Cluster XML of the -cluster-xml folder that changed since the last run with --jobs\n"
+              "A manifest of the converted files is kept inside the -output folder")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("-registry-index")
+        .help("Path to a binary index of the -cluster-xml folder\n"
+              "The index is created on the first run, later runs only parse the Cluster XML that changed");
+
+    program.add_argument("-object")
+        .help("ObjectID or ObjectURN of an object of the -registry-index that should be converted\n"
+              "Can be given multiple times, every object of the registry is converted if it is not given")
+        .append();
+
+    program.add_argument("--serve")
+        .help("Serve conversion requests on the given unix domain socket instead of converting files\n"
+              "The -cluster-xml folder is loaded as registry if -registry-index is given");
+
+    program.add_argument("--verify")
+        .help("Verify that every Cluster XML of -cluster-xml survives the round trip LwM2M -> SDF -> LwM2M -> SDF\n"
+              "The paths that differ are saved as a json report to the given path, --jobs sets the number of threads");
+
+    program.add_argument("-validate-lwm2m")
+        .help("Path to the xsd schema used by the server to validate LwM2M");
+
+    program.add_argument("--stats")
+        .help("Save the wall time, CPU time, bytes read and written and peak memory of every stage\n"
+              "and of every input file as a json report to the given path");
+
+    program.add_argument("--indent")
+        .help("Number of spaces used to indent the SDF JSON output, a negative number writes compact JSON")
+        .default_value(4)
+        .scan<'i', int>();
+
+    program.add_argument("--format")
+        .help("Format of the SDF output files, either json, cbor or msgpack\n"
+              "SDF input files are read in the format given by their extension")
+        .default_value(std::string("json"));
+
     program.add_argument("-validate")
         .help("Validate the output files\n"
               "Requires the path to the schema for the output files as an input");
 
     program.add_argument("-o", "-output")
-        .required()
         .help("Specify the output file\n"
               "For the LwM2M to SDF conversion, this will get split up into -model and -mapping\n"
-              "For the SDF to LwM2M conversion, this will get split up into -device and -clusters");
+              "For the SDF to LwM2M conversion, this will get split up into -device and -clusters\n"
+              "Required for every conversion");
 
     try {
         program.parse_args(argc, argv);
@@ -105,6 +192,79 @@ int main(int argc, char *argv[]) {
         std::exit(1);
     }
 
+    // Keep the registry and the schemas loaded and answer requests until the server gets stopped
+    if (program.is_used("--serve")) {
+        ServerOptions options;
+        options.socket_path = program.get<std::string>("--serve");
+        if (program.is_used("--jobs")) {
+            int jobs = program.get<int>("--jobs");
+            if (jobs < 0) {
+                std::cerr << "The number of jobs has to be positive" << std::endl;
+                std::exit(1);
+            }
+            options.jobs = static_cast<std::size_t>(jobs);
+        }
+        if (program.is_used("-registry-index")) {
+            if (!program.is_used("-cluster-xml")) {
+                std::cerr << "The -registry-index requires -cluster-xml to be a folder" << std::endl;
+                std::exit(1);
+            }
+            options.registry_directory = program.get<std::string>("-cluster-xml");
+            options.registry_index = program.get<std::string>("-registry-index");
+        }
+        if (program.is_used("-validate")) {
+            options.sdf_schema = program.get<std::string>("-validate");
+        }
+        if (program.is_used("-validate-lwm2m")) {
+            options.lwm2m_schema = program.get<std::string>("-validate-lwm2m");
+        }
+        return RunServer(options) == 0 ? 0 : 1;
+    }
+
+    // Verify the round trip of the Cluster XML without writing any conversion result
+    if (program.is_used("--verify")) {
+        if (!program.is_used("-cluster-xml")) {
+            std::cerr << "--verify requires -cluster-xml" << std::endl;
+            std::exit(1);
+        }
+        VerifyOptions options;
+        options.input_path = program.get<std::string>("-cluster-xml");
+        options.report_path = program.get<std::string>("--verify");
+        if (program.is_used("--jobs")) {
+            int jobs = program.get<int>("--jobs");
+            if (jobs < 0) {
+                std::cerr << "The number of jobs has to be positive" << std::endl;
+                std::exit(1);
+            }
+            options.jobs = static_cast<std::size_t>(jobs);
+        }
+        Stats stats;
+        options.stats = program.is_used("--stats") ? &stats : nullptr;
+        int result = VerifyRoundtrip(options);
+        if (options.stats != nullptr and stats.Save(program.get<std::string>("--stats").c_str()) != 0) {
+            std::cerr << "Failed to save the stats" << std::endl;
+            return 1;
+        }
+        return result == 0 ? 0 : 1;
+    }
+
+    // Every conversion writes its result, only the server works without an output
+    if ((program.is_used("--lwm2m-to-sdf") or program.is_used("--sdf-to-lwm2m")) and !program.is_used("-output")) {
+        std::cerr << "-output: required." << std::endl;
+        std::cerr << program;
+        std::exit(1);
+    }
+
+    // Measurements are only taken if a report was requested
+    Stats stats;
+    Stats* stats_ptr = program.is_used("--stats") ? &stats : nullptr;
+
+    int indent = program.get<int>("--indent");
+    SdfFormat format;
+    if (ParseSdfFormat(program.get<std::string>("--format"), format) != 0) {
+        std::exit(1);
+    }
+
     // Check if the conversion direction is lwm2m to sdf
     if (program.is_used("--lwm2m-to-sdf")) {
         // Check if the result should be validated
@@ -119,23 +279,60 @@ int main(int argc, char *argv[]) {
         // Check if the path to one or more cluster definitions was given
         if (program.is_used("-cluster-xml")) {
             auto path_cluster_xml = program.get<std::string>("-cluster-xml");
-            std::list<pugi::xml_document> cluster_xml_list;
+
+            // Convert every Cluster XML of the folder on its own if a number of jobs was given
+            if (program.is_used("--jobs") and std::filesystem::is_directory(path_cluster_xml)) {
+                int jobs = program.get<int>("--jobs");
+                if (jobs < 0) {
+                    std::cerr << "The number of jobs has to be positive" << std::endl;
+                    std::exit(1);
+                }
+                BatchOptions options;
+                options.input_directory = path_cluster_xml;
+                options.output_directory = program.get<std::string>("-output");
+                options.jobs = static_cast<std::size_t>(jobs);
+                int io_threads = program.get<int>("--io-threads");
+                if (io_threads < 0) {
+                    std::cerr << "The number of I/O threads has to be positive" << std::endl;
+                    std::exit(1);
+                }
+                options.io_threads = static_cast<std::size_t>(io_threads);
+                if (validate) {
+                    options.validation_schema = program.get<std::string>("-validate");
+                }
+                options.incremental = program.is_used("--incremental");
+                options.indent = indent;
+                options.format = format;
+                options.stats = stats_ptr;
+                int result = ConvertLwm2mDirectory(options);
+                if (stats_ptr != nullptr and stats.Save(program.get<std::string>("--stats").c_str()) != 0) {
+                    std::cerr << "Failed to save the stats" << std::endl;
+                    return 1;
+                }
+                return result == 0 ? 0 : 1;
+            }
+
             // Check if the given path points onto a folder or a file
             json sdf_model;
             json sdf_mapping;
+            std::vector<std::string> cluster_xml_paths;
             // Check if the given -cluster-xml value is a path or a file
-            if (std::filesystem::is_directory(path_cluster_xml)) {
+            bool use_index = program.is_used("-registry-index");
+            if (use_index) {
+                if (!std::filesystem::is_directory(path_cluster_xml)) {
+                    std::cerr << "The -registry-index requires -cluster-xml to be a folder" << std::endl;
+                    std::exit(1);
+                }
+            } else if (std::filesystem::is_directory(path_cluster_xml)) {
                 std::cout << "Loading and Parsing every Cluster XML of the given path" << std::endl;
                 for (const auto &dir_entry: recursive_directory_iterator(path_cluster_xml)) {
-                    pugi::xml_document cluster_xml;
-                    LoadXmlFile(dir_entry.path().c_str(), cluster_xml);
-                    cluster_xml_list.push_back(std::move(cluster_xml));
+                    if (dir_entry.is_regular_file()) {
+                        cluster_xml_paths.push_back(dir_entry.path().string());
+                    }
                 }
             } else {
                 std::cout << "Loading Cluster XML" << std::endl;
-                pugi::xml_document cluster_xml;
-                LoadXmlFile(path_cluster_xml.c_str(), cluster_xml);
-                cluster_xml_list.push_back(std::move(cluster_xml));
+                cluster_xml_paths.push_back(path_cluster_xml);
             }
             // If a device type definition was loaded, convert both of the files
             if (!path_device_xml.empty()) {
@@ -144,11 +341,80 @@ int main(int argc, char *argv[]) {
                 LoadXmlFile(path_device_xml.c_str(), device_xml);
                 std::cout << "Converting LwM2M to SDF" << std::endl;
                 //ConvertLwm2mToSdf(std::move(device_xml), cluster_xml_list, sdf_model, sdf_mapping);
+            }
+                // Objects of an indexed registry are converted without parsing their xml
+            else if (use_index) {
+                std::cout << "Loading Registry Index" << std::endl;
+                lwm2m::ObjectIndex registry_index;
+                if (registry_index.Update(path_cluster_xml, program.get<std::string>("-registry-index").c_str()) != 0) {
+                    std::cerr << "Failed to update the registry index" << std::endl;
+                    std::exit(1);
+                }
+                std::cout << "Converting LwM2M to SDF" << std::endl;
+                if (program.is_used("-object")) {
+                    for (const auto &key: program.get<std::vector<std::string>>("-object")) {
+                        // Keys consisting of digits only are ObjectIDs, everything else is an ObjectURN
+                        lwm2m::ObjectView object;
+                        bool is_id = !key.empty() and key.size() < 10 and key.find_first_not_of("0123456789") == std::string::npos;
+                        int result = is_id ? registry_index.Find(std::stoi(key), object)
+                                           : registry_index.FindByUrn(key, object);
+                        if (result != 0) {
+                            std::cerr << "Object not found in the registry: " << key << std::endl;
+                            std::exit(1);
+                        }
+                        MapLwm2mObject(object, sdf_model, sdf_mapping);
+                    }
+                } else {
+                    for (std::size_t i = 0; i < registry_index.Size(); i++) {
+                        MapLwm2mObject(registry_index.Get(i), sdf_model, sdf_mapping);
+                    }
+                }
+            }
+                // The objects of a single Cluster XML bundle are converted in parallel if a number of jobs was given
+            else if (program.is_used("--jobs") and cluster_xml_paths.size() == 1) {
+                int jobs = program.get<int>("--jobs");
+                if (jobs < 0) {
+                    std::cerr << "The number of jobs has to be positive" << std::endl;
+                    std::exit(1);
+                }
+                std::cout << "Converting LwM2M to SDF" << std::endl;
+                const std::string& path = cluster_xml_paths.front();
+                StageTimer load_timer(stats_ptr, Stage::Load, path);
+                XmlArenaScope arena_scope(ThreadXmlArena());
+                MappedXmlDocument cluster_xml;
+                if (LoadXmlFileMapped(path.c_str(), cluster_xml) != 0) {
+                    std::exit(1);
+                }
+                load_timer.AddBytesRead(cluster_xml.file.Size());
+                load_timer.Stop();
+                StageTimer convert_timer(stats_ptr, Stage::Convert, path);
+                if (ConvertLwm2mToSdf(cluster_xml.document, sdf_model, sdf_mapping, static_cast<std::size_t>(jobs)) != 0) {
+                    std::cerr << "Failed to convert " << path << std::endl;
+                    std::exit(1);
+                }
             }
                 // Otherwise we just convert the list of clusters
             else {
                 std::cout << "Converting LwM2M to SDF" << std::endl;
-                //ConvertLwm2mToSdf(std::nullopt, cluster_xml_list, sdf_model, sdf_mapping);
+                // Every Cluster XML is streamed into the sdf-model, so no DOM has to be kept alive
+                for (const auto &path: cluster_xml_paths) {
+                    std::ifstream cluster_stream(path, std::ios::binary);
+                    if (!cluster_stream) {
+                        std::cerr << "Failed to load XML file: " << path << std::endl;
+                        std::exit(1);
+                    }
+                    // Streamed files are parsed while they get converted, so both are measured as convert
+                    StageTimer convert_timer(stats_ptr, Stage::Convert, path);
+                    if (ConvertLwm2mToSdf(cluster_stream, sdf_model, sdf_mapping) != 0) {
+                        std::cerr << "Failed to convert " << path << std::endl;
+                        std::exit(1);
+                    }
+                    std::error_code error_code;
+                    auto size = std::filesystem::file_size(path, error_code);
+                    if (!error_code) {
+                        convert_timer.AddBytesRead(size);
+                    }
+                }
             }
 
             // Check if round-tripping was selected
@@ -157,10 +423,15 @@ int main(int argc, char *argv[]) {
                 std::cout << "Converting SDF to LwM2M..." << std::endl;
 
                 std::optional<pugi::xml_document> optional_device_xml;
-                cluster_xml_list.clear();
+                std::vector<lwm2m::Object> lwm2m_objects;
 
                 // Convert SDF back to LwM2M
-                //ConvertSdfToLwm2m(sdf_model, sdf_mapping, optional_device_xml, cluster_xml_list);
+                StageTimer convert_timer(stats_ptr, Stage::Convert);
+                if (ConvertSdfToLwm2m(sdf_model, sdf_mapping, lwm2m_objects) != 0) {
+                    std::cerr << "Failed to convert SDF to LwM2M" << std::endl;
+                    std::exit(1);
+                }
+                convert_timer.Stop();
                 std::cout << "Successfully converted SDF to LwM2M!" << std::endl;
 
                 // Generate the output file path
@@ -169,13 +440,24 @@ int main(int argc, char *argv[]) {
                 GenerateLwm2mFilenames(program.get<std::string>("-output"), path_output_device_xml,
                                         path_output_cluster_xml);
 
+                // Compile the xsd schema once for every following validation
+                Lwm2mValidator lwm2m_validator;
+                if (validate and lwm2m_validator.LoadSchema(program.get<std::string>("-validate").c_str()) != 0) {
+                    std::cerr << "Failed to load the validation schema" << std::endl;
+                    std::exit(1);
+                }
+
                 if (optional_device_xml.has_value()) {
                     std::cout << "Saving Device XML..." << std::endl;
-                    SaveXmlFile(path_output_device_xml.c_str(), optional_device_xml.value());
+                    std::string xml_buffer;
+                    StageTimer write_timer(stats_ptr, Stage::Write, path_output_device_xml);
+                    SaveXmlFile(path_output_device_xml.c_str(), optional_device_xml.value(), xml_buffer);
+                    write_timer.AddBytesWritten(xml_buffer.size());
+                    write_timer.Stop();
                     std::cout << "Successfully saved Device XML!" << std::endl;
                     if (validate) {
-                        if (ValidateLwm2m(path_device_xml.c_str(), program.get<std::string>("-validate").c_str()) ==
-                            0) {
+                        StageTimer validate_timer(stats_ptr, Stage::Validate, path_output_device_xml);
+                        if (lwm2m_validator.ValidateMemory(xml_buffer.data(), xml_buffer.size()) == 0) {
                             std::cout << "Device XML valid!..." << std::endl;
                         } else {
                             std::cout << "Device not valid!..." << std::endl;
@@ -184,22 +466,11 @@ int main(int argc, char *argv[]) {
                 }
 
                 std::cout << "Saving Cluster XML..." << std::endl;
-                int counter = 0;
-                for (const auto &cluster_xml: cluster_xml_list) {
-                    // Generate a filename for each cluster by numbering them
-                    std::string path = path_output_cluster_xml + "_" + std::to_string(counter) + ".xml";
-                    SaveXmlFile(path.c_str(), cluster_xml);
-                    // If the validation flag was set we try to validate the xml against a xsd schema
-                    if (validate) {
-                        if (ValidateLwm2m(path.c_str(), program.get<std::string>("-validate").c_str())) {
-                            std::cout << "Cluster XML" << path << "valid!..." << std::endl;
-                        } else {
-                            std::cout << "Cluster XML" << path << "not valid!..." << std::endl;
-                        }
-                    }
-                    counter++;
+                // Every object is written into the same Cluster XML
+                if (SaveMeasuredLwm2mFile(path_output_cluster_xml, lwm2m_objects, validate ? &lwm2m_validator : nullptr,
+                                          stats_ptr) != 0) {
+                    std::exit(1);
                 }
-
                 std::cout << "Successfully saved Cluster XML!" << std::endl;
 
             }
@@ -208,23 +479,32 @@ int main(int argc, char *argv[]) {
                 // Generate filenames for SDF based on the -output parameter
                 std::string path_sdf_model;
                 std::string path_sdf_mapping;
-                GenerateSdfFilenames(program.get<std::string>("-output"), path_sdf_model, path_sdf_mapping);
+                GenerateSdfFilenames(program.get<std::string>("-output"), format, path_sdf_model, path_sdf_mapping);
+
+                // Compile the json schema once for every following validation
+                SdfValidator sdf_validator;
+                if (validate and sdf_validator.LoadSchema(program.get<std::string>("-validate").c_str()) != 0) {
+                    std::cerr << "Failed to load the validation schema" << std::endl;
+                    std::exit(1);
+                }
 
                 std::cout << "Saving JSON files...." << std::endl;
-                SaveJsonFile(path_sdf_model.c_str(), sdf_model);
+                SaveMeasuredSdfFile(path_sdf_model, sdf_model, format, indent, stats_ptr);
                 std::cout << "Successfully saved SDF-Model!" << std::endl;
                 if (validate) {
-                    if (ValidateSdf(path_sdf_model.c_str(), program.get<std::string>("-validate").c_str()) == 0) {
+                    StageTimer validate_timer(stats_ptr, Stage::Validate, path_sdf_model);
+                    if (sdf_validator.Validate(sdf_model) == 0) {
                         std::cout << "SDF-model valid!..." << std::endl;
                     } else {
                         std::cout << "SDF-model not valid!..." << std::endl;
                     }
                 }
 
-                SaveJsonFile(path_sdf_mapping.c_str(), sdf_mapping);
+                SaveMeasuredSdfFile(path_sdf_mapping, sdf_mapping, format, indent, stats_ptr);
                 std::cout << "Successfully saved SDF-Mapping!" << std::endl;
                 if (validate) {
-                    if (ValidateSdf(path_sdf_mapping.c_str(), program.get<std::string>("-validate").c_str()) == 0) {
+                    StageTimer validate_timer(stats_ptr, Stage::Validate, path_sdf_mapping);
+                    if (sdf_validator.Validate(sdf_mapping) == 0) {
                         std::cout << "SDF-mapping valid!..." << std::endl;
                     } else {
                         std::cout << "SDF-mapping not valid!..." << std::endl;
@@ -251,15 +531,20 @@ int main(int argc, char *argv[]) {
 
         std::cout << "Loading SDF-Model..." << std::endl;
         json sdf_model_json;
-        LoadJsonFile(path_sdf_model.c_str(), sdf_model_json);
+        LoadMeasuredSdfFile(path_sdf_model, sdf_model_json, stats_ptr);
 
         std::cout << "Loading SDF-Mapping..." << std::endl;
         json sdf_mapping_json;
-        LoadJsonFile(path_sdf_mapping.c_str(), sdf_mapping_json);
+        LoadMeasuredSdfFile(path_sdf_mapping, sdf_mapping_json, stats_ptr);
 
         std::optional<pugi::xml_document> optional_device_xml;
-        std::list<pugi::xml_document> cluster_xml_list;
-        //ConvertSdfToLwm2m(sdf_model_json, sdf_mapping_json, optional_device_xml, cluster_xml_list);
+        std::vector<lwm2m::Object> lwm2m_objects;
+        StageTimer convert_timer(stats_ptr, Stage::Convert);
+        if (ConvertSdfToLwm2m(sdf_model_json, sdf_mapping_json, lwm2m_objects) != 0) {
+            std::cerr << "Failed to convert SDF to LwM2M" << std::endl;
+            std::exit(1);
+        }
+        convert_timer.Stop();
 
         // Check if the round-tripping flag was set
         if (program.is_used("--roundtrip")) {
@@ -269,29 +554,44 @@ int main(int argc, char *argv[]) {
             sdf_mapping_json.clear();
 
             // Convert LwM2M back to SDF
-            //ConvertLwm2mToSdf(optional_device_xml, cluster_xml_list, sdf_model_json, sdf_mapping_json);
+            StageTimer roundtrip_timer(stats_ptr, Stage::Convert);
+            if (ConvertLwm2mToSdf(std::move(lwm2m_objects), sdf_model_json, sdf_mapping_json) != 0) {
+                std::cerr << "Failed to convert LwM2M to SDF" << std::endl;
+                std::exit(1);
+            }
+            roundtrip_timer.Stop();
             std::cout << "Successfully converted LwM2M to SDF!" << std::endl;
 
             // Generate filenames for SDF based on the -output parameter
             std::string path_output_sdf_model;
             std::string path_output_sdf_mapping;
-            GenerateSdfFilenames(program.get<std::string>("-output"), path_sdf_model, path_sdf_mapping);
+            GenerateSdfFilenames(program.get<std::string>("-output"), format, path_output_sdf_model,
+                                 path_output_sdf_mapping);
+
+            // Compile the json schema once for every following validation
+            SdfValidator sdf_validator;
+            if (validate and sdf_validator.LoadSchema(program.get<std::string>("-validate").c_str()) != 0) {
+                std::cerr << "Failed to load the validation schema" << std::endl;
+                std::exit(1);
+            }
 
             std::cout << "Saving JSON files...." << std::endl;
-            SaveJsonFile(path_output_sdf_model.c_str(), sdf_model_json);
+            SaveMeasuredSdfFile(path_output_sdf_model, sdf_model_json, format, indent, stats_ptr);
             std::cout << "Successfully saved SDF-Model!" << std::endl;
             if (validate) {
-                if (ValidateSdf(path_output_sdf_model.c_str(), program.get<std::string>("-validate").c_str()) == 0) {
+                StageTimer validate_timer(stats_ptr, Stage::Validate, path_output_sdf_model);
+                if (sdf_validator.Validate(sdf_model_json) == 0) {
                     std::cout << "SDF-model valid!..." << std::endl;
                 } else {
                     std::cout << "SDF-model not valid!..." << std::endl;
                 }
             }
 
-            SaveJsonFile(path_output_sdf_mapping.c_str(), sdf_mapping_json);
+            SaveMeasuredSdfFile(path_output_sdf_mapping, sdf_mapping_json, format, indent, stats_ptr);
             std::cout << "Successfully saved SDF-Mapping!" << std::endl;
             if (validate) {
-                if (ValidateSdf(path_output_sdf_mapping.c_str(), program.get<std::string>("-validate").c_str()) == 0) {
+                StageTimer validate_timer(stats_ptr, Stage::Validate, path_output_sdf_mapping);
+                if (sdf_validator.Validate(sdf_mapping_json) == 0) {
                     std::cout << "SDF-mapping valid!..." << std::endl;
                 } else {
                     std::cout << "SDF-mapping not valid!..." << std::endl;
@@ -303,11 +603,23 @@ int main(int argc, char *argv[]) {
             std::string path_cluster_xml;
             GenerateLwm2mFilenames(program.get<std::string>("-output"), path_device_xml, path_cluster_xml);
 
+            // Compile the xsd schema once for every following validation
+            Lwm2mValidator lwm2m_validator;
+            if (validate and lwm2m_validator.LoadSchema(program.get<std::string>("-validate").c_str()) != 0) {
+                std::cerr << "Failed to load the validation schema" << std::endl;
+                std::exit(1);
+            }
+
             if (optional_device_xml.has_value()) {
                 std::cout << "Saving Device XML..." << std::endl;
-                SaveXmlFile(path_device_xml.c_str(), optional_device_xml.value());
+                std::string xml_buffer;
+                StageTimer write_timer(stats_ptr, Stage::Write, path_device_xml);
+                SaveXmlFile(path_device_xml.c_str(), optional_device_xml.value(), xml_buffer);
+                write_timer.AddBytesWritten(xml_buffer.size());
+                write_timer.Stop();
                 if (validate) {
-                    if (ValidateLwm2m(path_device_xml.c_str(), program.get<std::string>("-validate").c_str()) == 0) {
+                    StageTimer validate_timer(stats_ptr, Stage::Validate, path_device_xml);
+                    if (lwm2m_validator.ValidateMemory(xml_buffer.data(), xml_buffer.size()) == 0) {
                         std::cout << "Device XML valid!..." << std::endl;
                     } else {
                         std::cout << "Device not valid!..." << std::endl;
@@ -316,20 +628,12 @@ int main(int argc, char *argv[]) {
             }
 
             std::cout << "Saving Cluster XML..." << std::endl;
-            int counter = 0;
-            for (const auto& cluster_xml : cluster_xml_list) {
-                // Generate a filename for each cluster by numbering them
-                std::string path = path_cluster_xml + "_" + std::to_string(counter) + ".xml";
-                SaveXmlFile(path.c_str(), cluster_xml);
-                if (validate) {
-                    if (ValidateLwm2m(path.c_str(), program.get<std::string>("-validate").c_str())) {
-                        std::cout << "Cluster XML" << path << "valid!..." << std::endl;
-                    } else {
-                        std::cout << "Cluster XML" << path << "not valid!..." << std::endl;
-                    }
-                }
-                counter ++;
+            // Every object is written into the same Cluster XML
+            if (SaveMeasuredLwm2mFile(path_cluster_xml, lwm2m_objects, validate ? &lwm2m_validator : nullptr,
+                                      stats_ptr) != 0) {
+                std::exit(1);
             }
+            std::cout << "Successfully saved Cluster XML!" << std::endl;
         }
     }
         // Print help of neither convert-to-sdf nor convert-to-lwm2m are given
@@ -337,5 +641,10 @@ int main(int argc, char *argv[]) {
         std::cout << program;
     }
 
+    if (stats_ptr != nullptr and stats.Save(program.get<std::string>("--stats").c_str()) != 0) {
+        std::cerr << "Failed to save the stats" << std::endl;
+        return 1;
+    }
+
     return 0;
 }
@@ -23,8 +23,19 @@
  * Functions to load and save xml and json files.
  */
 
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include <pugixml.hpp>
+#include <json_writer.h>
+#include <lwm2m.h>
+#include <lwm2m_writer.h>
+#include <mapped_file.h>
 #include "validator.h"
 
 #ifndef SDF_LWM2M_CONVERTER_SRC_MAIN_H_
@@ -53,16 +64,32 @@ static inline int LoadJsonFile(const char* path, nlohmann::ordered_json& json_fi
 
 //! @brief Save a json object into a json file.
 //!
-//! This function saves a json object into a new json file.
+//! This function saves a json object into a new json file. The json is
+//! serialized while it is written, so the whole document is never kept as text.
 //!
 //! @param path The path to the file.
 //! @param json_file The input json file.
+//! @param indent Number of spaces per level, negative for compact json.
+//! @param bytes_written Optional number of bytes written into the file.
 //! @return 0 on success, negative on failure.
-static inline int SaveJsonFile(const char* path, const nlohmann::ordered_json& json_file)
+static inline int SaveJsonFile(const char* path, const nlohmann::ordered_json& json_file, int indent = 4,
+                               std::uint64_t* bytes_written = nullptr)
 {
     try {
-        std::ofstream f(path);
-        f << json_file.dump(4);
+        std::ofstream f(path, std::ios::binary);
+        if (!f) {
+            std::cerr << "Failed to open JSON file: " << path << std::endl;
+            return -1;
+        }
+        JsonWriter writer(f, indent);
+        writer.Write(json_file);
+        if (writer.Flush() != 0) {
+            std::cerr << "Failed to save JSON file: " << path << std::endl;
+            return -1;
+        }
+        if (bytes_written != nullptr) {
+            *bytes_written = writer.BytesWritten();
+        }
     }
     catch (const std::exception& err) {
         std::cerr << "Failed to save JSON file: " << path << std::endl;
@@ -72,6 +99,21 @@ static inline int SaveJsonFile(const char* path, const nlohmann::ordered_json& j
     return 0;
 }
 
+//! @brief Save already serialized content into a file.
+//!
+//! @param path The path to the file.
+//! @param content The content of the file.
+//! @return 0 on success, negative on failure.
+static inline int SaveTextFile(const char* path, const std::string& content)
+{
+    std::ofstream f(path, std::ios::binary);
+    if (!f.write(content.data(), static_cast<std::streamsize>(content.size()))) {
+        std::cerr << "Failed to save file: " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
 //!@brief Load a xml file.
 //!
 //! This function loads the xml file for a given path.
@@ -89,6 +131,53 @@ static inline int LoadXmlFile(const char* path, pugi::xml_document& xml_file)
     return 0;
 }
 
+//! Xml document that is parsed in place from a memory mapped file.
+//! The document references the mapping, so the members are destroyed in reverse order.
+struct MappedXmlDocument {
+    MappedFile file;
+    pugi::xml_document document;
+};
+
+//!@brief Parse a xml file that has already been mapped.
+//!
+//! This allows the mapped content to be inspected before it gets modified
+//! by parsing it in place.
+//!
+//! @param path The path to the file, only used for error messages.
+//! @param xml_file The xml file with an open mapping.
+//! @return 0 on success, negative on failure.
+static inline int ParseMappedXmlFile(const char* path, MappedXmlDocument& xml_file)
+{
+    xml_file.document.reset();
+    pugi::xml_parse_result result = xml_file.document.load_buffer_inplace(xml_file.file.Data(), xml_file.file.Size(),
+                                                                          lwm2m::kParseOptions);
+    if (!result) {
+        std::cerr << "Failed to load XML file: " << path << std::endl;
+        std::cerr << result.description() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+//!@brief Load a xml file through a memory mapping.
+//!
+//! This function maps the xml file for a given path copy-on-write and parses it
+//! in place. The strings of the document point into the mapping instead of a
+//! copy of the file, only the pages pugixml modifies while parsing get copied.
+//!
+//! @param path The path to the file.
+//! @param xml_file The resulting xml file.
+//! @return 0 on success, negative on failure.
+static inline int LoadXmlFileMapped(const char* path, MappedXmlDocument& xml_file)
+{
+    xml_file.document.reset();
+    if (xml_file.file.Open(path, true) != 0) {
+        std::cerr << "Failed to load XML file: " << path << std::endl;
+        return -1;
+    }
+    return ParseMappedXmlFile(path, xml_file);
+}
+
 //! @brief Save a xml object into a xml file.
 //!
 //! The function saves a xml object into a xml file.
@@ -98,7 +187,293 @@ static inline int LoadXmlFile(const char* path, pugi::xml_document& xml_file)
 //! @return 0 on success, negative on failure.
 static inline int SaveXmlFile(const char* path, const pugi::xml_document& xml_file)
 {
-    return xml_file.save_file(path);
+    if (!xml_file.save_file(path)) {
+        std::cerr << "Failed to save XML file: " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+//! @brief Save a xml object into a xml file and keep the serialized xml.
+//!
+//! The function serializes a xml object into a buffer and writes the buffer
+//! into a xml file. The buffer can be used afterwards, for example for the
+//! validation, without reading the file back from disk.
+//!
+//! @param path The path to the file.
+//! @param xml_file The input xml file.
+//! @param buffer The serialized xml file.
+//! @return 0 on success, negative on failure.
+static inline int SaveXmlFile(const char* path, const pugi::xml_document& xml_file, std::string& buffer)
+{
+    // Serializes with the same settings as pugi::xml_document::save_file
+    struct StringWriter : pugi::xml_writer {
+        explicit StringWriter(std::string& output) : output(output) {}
+        void write(const void* data, size_t size) override
+        {
+            output.append(static_cast<const char*>(data), size);
+        }
+        std::string& output;
+    };
+
+    buffer.clear();
+    StringWriter writer(buffer);
+    xml_file.save(writer);
+
+    std::ofstream f(path, std::ios::binary);
+    if (!f.write(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+        std::cerr << "Failed to save XML file: " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+//! Serialization formats of sdf-model and sdf-mapping files
+enum class SdfFormat {
+    Json,
+    Cbor,
+    MessagePack
+};
+
+//! @brief Get the format for the name used on the command line.
+//!
+//! @param name The name of the format, either json, cbor or msgpack.
+//! @param format The resulting format.
+//! @return 0 on success, negative if the name is unknown.
+static inline int ParseSdfFormat(const std::string& name, SdfFormat& format)
+{
+    if (name == "json") {
+        format = SdfFormat::Json;
+    } else if (name == "cbor") {
+        format = SdfFormat::Cbor;
+    } else if (name == "msgpack") {
+        format = SdfFormat::MessagePack;
+    } else {
+        std::cerr << "Unknown SDF format: " << name << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+//! Helper function that returns the file extension of a format
+static inline const char* SdfFormatExtension(SdfFormat format)
+{
+    switch (format) {
+        case SdfFormat::Cbor:
+            return ".cbor";
+        case SdfFormat::MessagePack:
+            return ".msgpack";
+        case SdfFormat::Json:
+            break;
+    }
+    return ".json";
+}
+
+//! Helper function that detects the format of a file by its extension, unknown extensions are treated as json
+static inline SdfFormat SdfFormatFromPath(const std::string& path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    if (extension == ".cbor") {
+        return SdfFormat::Cbor;
+    }
+    if (extension == ".msgpack" or extension == ".mpk") {
+        return SdfFormat::MessagePack;
+    }
+    return SdfFormat::Json;
+}
+
+//! @brief Load a sdf-model or sdf-mapping file.
+//!
+//! Json files are parsed as text, cbor and msgpack files are decoded
+//! straight from a memory mapping of the file. The format is detected by the
+//! extension of the path.
+//!
+//! @param path The path to the file.
+//! @param json_file The resulting json object.
+//! @return 0 on success, negative on failure.
+static inline int LoadSdfFile(const char* path, nlohmann::ordered_json& json_file)
+{
+    SdfFormat format = SdfFormatFromPath(path);
+    if (format == SdfFormat::Json) {
+        return LoadJsonFile(path, json_file);
+    }
+    MappedFile file;
+    if (file.Open(path) != 0) {
+        std::cerr << "Failed to load SDF file: " << path << std::endl;
+        return -1;
+    }
+    try {
+        const auto* begin = reinterpret_cast<const std::uint8_t*>(file.Data());
+        const auto* end = begin + file.Size();
+        if (format == SdfFormat::Cbor) {
+            json_file = nlohmann::ordered_json::from_cbor(begin, end);
+        } else {
+            json_file = nlohmann::ordered_json::from_msgpack(begin, end);
+        }
+    }
+    catch (const std::exception& err) {
+        std::cerr << "Failed to load SDF file: " << path << std::endl;
+        std::cerr << err.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+//! @brief Save a sdf-model or sdf-mapping file in the given format.
+//!
+//! The binary formats are encoded straight into the file stream.
+//!
+//! @param path The path to the file.
+//! @param json_file The input json file.
+//! @param format The format of the file.
+//! @param indent Number of spaces per level for json, negative for compact json.
+//! @param bytes_written Optional number of bytes written into the file.
+//! @return 0 on success, negative on failure.
+static inline int SaveSdfFile(const char* path, const nlohmann::ordered_json& json_file, SdfFormat format,
+                              int indent = 4, std::uint64_t* bytes_written = nullptr)
+{
+    if (format == SdfFormat::Json) {
+        return SaveJsonFile(path, json_file, indent, bytes_written);
+    }
+    try {
+        std::ofstream f(path, std::ios::binary);
+        if (!f) {
+            std::cerr << "Failed to open SDF file: " << path << std::endl;
+            return -1;
+        }
+        if (format == SdfFormat::Cbor) {
+            nlohmann::ordered_json::to_cbor(json_file, f);
+        } else {
+            nlohmann::ordered_json::to_msgpack(json_file, f);
+        }
+        if (!f.flush()) {
+            std::cerr << "Failed to save SDF file: " << path << std::endl;
+            return -1;
+        }
+        if (bytes_written != nullptr) {
+            *bytes_written = static_cast<std::uint64_t>(f.tellp());
+        }
+    }
+    catch (const std::exception& err) {
+        std::cerr << "Failed to save SDF file: " << path << std::endl;
+        std::cerr << err.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+//! @brief Save lwm2m objects into a xml file.
+//!
+//! The objects are written by a lwm2m::XmlWriter straight into the file,
+//! without building a DOM.
+//!
+//! @param path The path to the file.
+//! @param objects The objects of the file.
+//! @param bytes_written Optional number of bytes written into the file.
+//! @return 0 on success, negative on failure.
+static inline int SaveLwm2mFile(const char* path, const std::vector<lwm2m::Object>& objects,
+                                std::uint64_t* bytes_written = nullptr)
+{
+    std::ofstream f(path, std::ios::binary);
+    if (!f) {
+        std::cerr << "Failed to open XML file: " << path << std::endl;
+        return -1;
+    }
+    lwm2m::XmlWriter writer(f);
+    writer.BeginDocument();
+    for (const auto& object : objects) {
+        object.Serialize(writer);
+    }
+    writer.EndDocument();
+    if (writer.Flush() != 0) {
+        std::cerr << "Failed to save XML file: " << path << std::endl;
+        return -1;
+    }
+    if (bytes_written != nullptr) {
+        *bytes_written = writer.BytesWritten();
+    }
+    return 0;
+}
+
+//! @brief Save lwm2m objects into a xml file and keep the serialized xml.
+//!
+//! The serialized xml can be used afterwards, for example for the
+//! validation, without reading the file back from disk.
+//!
+//! @param path The path to the file.
+//! @param objects The objects of the file.
+//! @param buffer The serialized xml file.
+//! @return 0 on success, negative on failure.
+static inline int SaveLwm2mFile(const char* path, const std::vector<lwm2m::Object>& objects, std::string& buffer)
+{
+    buffer.clear();
+    {
+        lwm2m::XmlWriter writer(buffer);
+        writer.BeginDocument();
+        for (const auto& object : objects) {
+            object.Serialize(writer);
+        }
+        writer.EndDocument();
+    }
+    return SaveTextFile(path, buffer);
+}
+
+//! Helper function that generates sdf-model and sdf-mapping filenames
+//! Generates filenames of the format "path/to/file[-model|-mapping].json"
+static inline void GenerateSdfFilenames(const std::string& input, std::string& sdf_model_name, std::string& sdf_mapping_name){
+    auto last_dot = input.find_last_of('.');
+
+    sdf_model_name.append(input.substr(0, last_dot));
+    sdf_model_name.append("-model");
+    sdf_model_name.append(input.substr(last_dot));
+
+    sdf_mapping_name.append(input.substr(0, last_dot));
+    sdf_mapping_name.append("-mapping");
+    sdf_mapping_name.append(input.substr(last_dot));
+}
+
+//! Helper function that generates sdf-model and sdf-mapping filenames for a format
+//! Json keeps the extension of the input, the binary formats replace it with their own
+//! Generates filenames of the format "path/to/file[-model|-mapping].cbor"
+static inline void GenerateSdfFilenames(const std::string& input, SdfFormat format, std::string& sdf_model_name,
+                                        std::string& sdf_mapping_name){
+    if (format == SdfFormat::Json) {
+        GenerateSdfFilenames(input, sdf_model_name, sdf_mapping_name);
+        return;
+    }
+    std::string stem = std::filesystem::path(input).replace_extension().string();
+    sdf_model_name.append(stem).append("-model").append(SdfFormatExtension(format));
+    sdf_mapping_name.append(stem).append("-mapping").append(SdfFormatExtension(format));
+}
+
+//! Helper function that generates device and cluster filenames
+//! Generates filenames of the format "path/to/file[-device|-cluster].xml"
+static inline void GenerateLwm2mFilenames(const std::string& input, std::string& device_xml_name, std::string& cluster_xml_name){
+    auto last_dot = input.find_last_of('.');
+
+    device_xml_name.append(input.substr(0, last_dot));
+    device_xml_name.append("-device");
+    device_xml_name.append(input.substr(last_dot));
+
+    cluster_xml_name.append(input.substr(0, last_dot));
+    cluster_xml_name.append("-cluster");
+    cluster_xml_name.append(input.substr(last_dot));
+}
+
+//! @brief Create the result of a file that failed to process.
+//!
+//! Shared by the per file results of the batch conversion and the verification,
+//! which both report a status and a message.
+//!
+//!@param message The reason of the failure.
+//!@return The result with a negative status.
+template <typename Result>
+static inline Result Failure(std::string message)
+{
+    Result result;
+    result.status = -1;
+    result.message = std::move(message);
+    return result;
 }
 
 #endif //SDF_LWM2M_CONVERTER_SRC_MAIN_H_
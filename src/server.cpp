@@ -0,0 +1,515 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "server.h"
+#include <iostream>
+
+#ifdef _WIN32
+
+int RunServer(const ServerOptions& options)
+{
+    std::cerr << "The conversion server is not available on this platform" << std::endl;
+    return -1;
+}
+
+#else
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+#include <pugixml.hpp>
+#include <converter.h>
+#include <lwm2m_index.h>
+#include <thread_pool.h>
+#include <xml_arena.h>
+#include "main.h"
+
+using json = nlohmann::ordered_json;
+
+namespace {
+
+//! Larger frames are rejected and close the connection
+constexpr std::uint32_t kMaxFrameSize = 64 * 1024 * 1024;
+//! Interval in which the poll loop checks for a requested shutdown
+constexpr int kPollTimeoutMs = 200;
+//! Connections that stall for longer while a frame is read or written get closed
+constexpr int kIoTimeoutSeconds = 30;
+
+std::atomic<bool> stop_requested{false};
+
+extern "C" void HandleStopSignal(int)
+{
+    stop_requested = true;
+}
+
+//! State that is loaded once and shared by every connection
+struct ServerState {
+    lwm2m::ObjectIndex registry;
+    bool has_registry = false;
+    SdfValidator sdf_validator;
+    bool has_sdf_schema = false;
+    Lwm2mValidator lwm2m_validator;
+    bool has_lwm2m_schema = false;
+};
+
+//! Connections that are currently served, they get shut down when the server stops
+class ConnectionSet {
+public:
+    void Add(int fd)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.insert(fd);
+    }
+
+    void Remove(int fd)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.erase(fd);
+    }
+
+    //! Wake every worker that waits for the rest of a request
+    void ShutdownAll()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int fd : connections_) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_set<int> connections_;
+};
+
+//! Connections handed back by the workers once their request has been answered
+//! A pipe wakes the poll loop, so the next request of the connection is noticed right away
+class ReturnedConnections {
+public:
+    ReturnedConnections() = default;
+    ReturnedConnections(const ReturnedConnections&) = delete;
+    ReturnedConnections& operator=(const ReturnedConnections&) = delete;
+
+    ~ReturnedConnections()
+    {
+        for (int fd : wake_fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    int Open()
+    {
+        if (pipe(wake_fds_) != 0) {
+            std::cerr << "Failed to create pipe: " << std::strerror(errno) << std::endl;
+            return -1;
+        }
+        for (int fd : wake_fds_) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+        return 0;
+    }
+
+    //! Descriptor that becomes readable once a connection has been returned
+    int WakeFd() const { return wake_fds_[0]; }
+
+    void Return(int fd)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connections_.push_back(fd);
+        }
+        char wake = 0;
+        if (write(wake_fds_[1], &wake, 1) < 0) {
+            // A full pipe already wakes the poll loop
+        }
+    }
+
+    //! Take every returned connection
+    std::vector<int> Take()
+    {
+        char buffer[64];
+        while (read(wake_fds_[0], buffer, sizeof(buffer)) > 0) {
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<int> connections;
+        connections.swap(connections_);
+        return connections;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<int> connections_;
+    int wake_fds_[2] = {-1, -1};
+};
+
+//! Function used to read exactly the given number of bytes, returns 0 on a closed connection
+int ReadExact(int fd, char* data, std::size_t size)
+{
+    std::size_t done = 0;
+    while (done < size) {
+        ssize_t count = read(fd, data + done, size - done);
+        if (count == 0) {
+            return 0;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += static_cast<std::size_t>(count);
+    }
+    return 1;
+}
+
+//! Function used to write exactly the given number of bytes
+int WriteExact(int fd, const char* data, std::size_t size)
+{
+    std::size_t done = 0;
+    while (done < size) {
+        ssize_t count = write(fd, data + done, size - done);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += static_cast<std::size_t>(count);
+    }
+    return 0;
+}
+
+//! Function used to read a frame, returns 0 on a closed connection
+int ReadFrame(int fd, std::string& payload)
+{
+    unsigned char length_bytes[4];
+    int result = ReadExact(fd, reinterpret_cast<char*>(length_bytes), sizeof(length_bytes));
+    if (result <= 0) {
+        return result;
+    }
+    std::uint32_t length = (static_cast<std::uint32_t>(length_bytes[0]) << 24) |
+                           (static_cast<std::uint32_t>(length_bytes[1]) << 16) |
+                           (static_cast<std::uint32_t>(length_bytes[2]) << 8) |
+                           static_cast<std::uint32_t>(length_bytes[3]);
+    if (length > kMaxFrameSize) {
+        std::cerr << "Rejected frame of " << length << " bytes" << std::endl;
+        return -1;
+    }
+    payload.resize(length);
+    return ReadExact(fd, payload.data(), length) > 0 ? 1 : -1;
+}
+
+//! Function used to write a frame
+int WriteFrame(int fd, const std::string& payload)
+{
+    auto length = static_cast<std::uint32_t>(payload.size());
+    unsigned char length_bytes[4] = {static_cast<unsigned char>(length >> 24),
+                                     static_cast<unsigned char>(length >> 16),
+                                     static_cast<unsigned char>(length >> 8),
+                                     static_cast<unsigned char>(length)};
+    if (WriteExact(fd, reinterpret_cast<const char*>(length_bytes), sizeof(length_bytes)) != 0) {
+        return -1;
+    }
+    return WriteExact(fd, payload.data(), payload.size());
+}
+
+//! Function used to create the response to a failed request
+json Failure(json response, const std::string& error)
+{
+    response["status"] = -1;
+    response["error"] = error;
+    return response;
+}
+
+//! Function used to convert the lwm2m of a request into sdf
+json ConvertRequest(const ServerState& state, json& request, json response)
+{
+    json sdf_model;
+    json sdf_mapping;
+    if (request.contains("xml")) {
+        // The request owns the xml, so it can be parsed in place
+        auto& xml = request["xml"].get_ref<std::string&>();
+        XmlArenaScope arena_scope(ThreadXmlArena());
+        pugi::xml_document lwm2m_xml;
+        pugi::xml_parse_result result = lwm2m_xml.load_buffer_inplace(xml.data(), xml.size(), lwm2m::kParseOptions);
+        if (!result) {
+            return Failure(std::move(response), std::string("Failed to parse xml: ") + result.description());
+        }
+        if (ConvertLwm2mToSdf(lwm2m_xml, sdf_model, sdf_mapping) != 0) {
+            return Failure(std::move(response), "Failed to convert xml");
+        }
+    }
+    if (request.contains("objects")) {
+        if (!state.has_registry) {
+            return Failure(std::move(response), "No registry loaded");
+        }
+        for (const auto& key : request["objects"]) {
+            // Numbers are ObjectIDs, strings are ObjectURNs
+            lwm2m::ObjectView object;
+            int result = key.is_number_integer() ? state.registry.Find(key.get<int>(), object)
+                                                 : state.registry.FindByUrn(key.get_ref<const std::string&>(), object);
+            if (result != 0) {
+                return Failure(std::move(response), "Object not found in the registry: " + key.dump());
+            }
+            if (MapLwm2mObject(object, sdf_model, sdf_mapping) != 0) {
+                return Failure(std::move(response), "Failed to convert object: " + key.dump());
+            }
+        }
+    }
+    if (request.value("validate", false)) {
+        if (!state.has_sdf_schema) {
+            return Failure(std::move(response), "No sdf schema loaded");
+        }
+        response["valid"] = state.sdf_validator.Validate(sdf_model) == 0 and
+                            state.sdf_validator.Validate(sdf_mapping) == 0;
+    }
+    response["status"] = 0;
+    response["sdfModel"] = std::move(sdf_model);
+    response["sdfMapping"] = std::move(sdf_mapping);
+    return response;
+}
+
+//! Function used to answer a single request
+json HandleRequest(const ServerState& state, json& request)
+{
+    json response = json::object();
+    if (!request.is_object()) {
+        return Failure(std::move(response), "Request is not a json object");
+    }
+    if (request.contains("id")) {
+        response["id"] = request["id"];
+    }
+    const std::string command = request.value("command", "");
+    if (command == "ping") {
+        response["status"] = 0;
+        return response;
+    }
+    if (command == "lwm2m-to-sdf") {
+        return ConvertRequest(state, request, std::move(response));
+    }
+    if (command == "validate-lwm2m") {
+        if (!state.has_lwm2m_schema) {
+            return Failure(std::move(response), "No lwm2m schema loaded");
+        }
+        const auto& xml = request.at("xml").get_ref<const std::string&>();
+        response["status"] = 0;
+        response["valid"] = state.lwm2m_validator.ValidateMemory(xml.data(), xml.size()) == 0;
+        return response;
+    }
+    return Failure(std::move(response), "Unknown command: " + command);
+}
+
+//! Function used to answer the next request of a connection
+//! Returns 0 if the connection can send further requests, negative if it has to be closed
+int ServeRequest(const ServerState& state, int fd)
+{
+    std::string payload;
+    if (ReadFrame(fd, payload) <= 0) {
+        return -1;
+    }
+    json response;
+    try {
+        json request = json::parse(payload);
+        response = HandleRequest(state, request);
+    }
+    catch (const std::exception& err) {
+        response = Failure(json::object(), err.what());
+    }
+    return WriteFrame(fd, response.dump());
+}
+
+//! Function used to limit how long a stalled client can keep a worker busy
+void SetIoTimeout(int fd)
+{
+    timeval timeout{};
+    timeout.tv_sec = kIoTimeoutSeconds;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+//! Function used to load the registry and to compile the schemas
+int LoadState(const ServerOptions& options, ServerState& state)
+{
+    if (!options.registry_directory.empty()) {
+        std::cout << "Loading Registry Index" << std::endl;
+        if (state.registry.Update(options.registry_directory, options.registry_index.c_str()) != 0) {
+            std::cerr << "Failed to update the registry index" << std::endl;
+            return -1;
+        }
+        state.has_registry = true;
+    }
+    if (!options.sdf_schema.empty()) {
+        if (state.sdf_validator.LoadSchema(options.sdf_schema.c_str()) != 0) {
+            std::cerr << "Failed to load the validation schema" << std::endl;
+            return -1;
+        }
+        state.has_sdf_schema = true;
+    }
+    if (!options.lwm2m_schema.empty()) {
+        if (state.lwm2m_validator.LoadSchema(options.lwm2m_schema.c_str()) != 0) {
+            std::cerr << "Failed to load the validation schema" << std::endl;
+            return -1;
+        }
+        state.has_lwm2m_schema = true;
+    }
+    return 0;
+}
+
+//! Function used to create the listening socket, a stale socket of a previous run is replaced
+int CreateSocket(const std::string& path)
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path is too long: " << path << std::endl;
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    struct stat file_stat {};
+    if (lstat(path.c_str(), &file_stat) == 0) {
+        if (!S_ISSOCK(file_stat.st_mode)) {
+            std::cerr << "Refusing to replace a file that is not a socket: " << path << std::endl;
+            return -1;
+        }
+        unlink(path.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 or listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on socket " << path << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+//! Function used to serve conversion requests on a unix domain socket
+int RunServer(const ServerOptions& options)
+{
+    ServerState state;
+    if (LoadState(options, state) != 0) {
+        return -1;
+    }
+
+    int listen_fd = CreateSocket(options.socket_path);
+    if (listen_fd < 0) {
+        return -1;
+    }
+
+    // Clients that disconnect early must not terminate the server
+    std::signal(SIGPIPE, SIG_IGN);
+    stop_requested = false;
+    std::signal(SIGINT, HandleStopSignal);
+    std::signal(SIGTERM, HandleStopSignal);
+
+    ReturnedConnections returned;
+    if (returned.Open() != 0) {
+        close(listen_fd);
+        return -1;
+    }
+    ConnectionSet connections;
+    // Connections waiting for their next request are only polled, they do not occupy a worker
+    std::vector<int> idle;
+    {
+        ThreadPool pool(options.jobs);
+        std::cout << "Listening on " << options.socket_path << " using " << pool.Size() << " threads" << std::endl;
+        std::vector<pollfd> polls;
+        while (!stop_requested) {
+            std::vector<int> returned_connections = returned.Take();
+            idle.insert(idle.end(), returned_connections.begin(), returned_connections.end());
+
+            polls.clear();
+            polls.push_back({listen_fd, POLLIN, 0});
+            polls.push_back({returned.WakeFd(), POLLIN, 0});
+            for (int fd : idle) {
+                polls.push_back({fd, POLLIN, 0});
+            }
+            int ready = poll(polls.data(), polls.size(), kPollTimeoutMs);
+            if (ready <= 0) {
+                continue;
+            }
+
+            // Every readable connection gets one task for its next request and is polled again once it is answered
+            std::size_t still_idle = 0;
+            for (std::size_t i = 2; i < polls.size(); i++) {
+                int client_fd = polls[i].fd;
+                if (polls[i].revents == 0) {
+                    idle[still_idle++] = client_fd;
+                    continue;
+                }
+                pool.Submit([&state, &connections, &returned, client_fd] {
+                    int result = -1;
+                    try {
+                        result = ServeRequest(state, client_fd);
+                    }
+                    catch (const std::exception& err) {
+                        std::cerr << err.what() << std::endl;
+                    }
+                    if (result == 0) {
+                        returned.Return(client_fd);
+                    } else {
+                        connections.Remove(client_fd);
+                        close(client_fd);
+                    }
+                });
+            }
+            idle.resize(still_idle);
+
+            if (polls[0].revents & POLLIN) {
+                int client_fd = accept(listen_fd, nullptr, nullptr);
+                if (client_fd >= 0) {
+                    SetIoTimeout(client_fd);
+                    connections.Add(client_fd);
+                    idle.push_back(client_fd);
+                }
+            }
+        }
+        std::cout << "Stopping server" << std::endl;
+        close(listen_fd);
+        connections.ShutdownAll();
+    }
+    // Every worker has finished, so the remaining connections are idle
+    std::vector<int> returned_connections = returned.Take();
+    idle.insert(idle.end(), returned_connections.begin(), returned_connections.end());
+    for (int fd : idle) {
+        close(fd);
+    }
+    unlink(options.socket_path.c_str());
+    return 0;
+}
+
+#endif
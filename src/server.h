@@ -0,0 +1,79 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Long-running conversion server listening on a local unix domain socket.
+ *
+ * Every message is a frame made up of the length of the payload as a 32 bit
+ * big endian integer followed by the payload, a json object.
+ *
+ * Requests contain a "command" and an optional "id" that is copied into the
+ * response. Every response contains a "status" of 0 on success or -1 together
+ * with an "error" message on failure.
+ *
+ * - "ping": Check if the server is alive.
+ * - "lwm2m-to-sdf": Convert the objects of the lwm2m definition in "xml" and
+ *   the registry objects listed in "objects" by their ObjectID or ObjectURN.
+ *   The response contains the "sdfModel" and the "sdfMapping", if "validate"
+ *   is true it also contains "valid".
+ * - "validate-lwm2m": Validate the lwm2m definition in "xml", the response
+ *   contains "valid".
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_SRC_SERVER_H_
+#define SDF_LWM2M_CONVERTER_SRC_SERVER_H_
+
+#include <cstddef>
+#include <string>
+
+//! Options of the conversion server
+struct ServerOptions {
+    //! Path of the unix domain socket
+    std::string socket_path;
+    //! Number of requests answered at the same time, 0 selects the hardware concurrency
+    std::size_t jobs = 0;
+    //! Directory of the registry objects that can be referenced by requests, empty if there is no registry
+    std::string registry_directory;
+    //! Path to the binary index of the registry
+    std::string registry_index;
+    //! Path to the json schema for sdf, empty if sdf cannot be validated
+    std::string sdf_schema;
+    //! Path to the xsd schema for lwm2m, empty if lwm2m cannot be validated
+    std::string lwm2m_schema;
+};
+
+//! @brief Serve conversion requests until the process gets interrupted.
+//!
+//! The registry and the schemas are loaded once before the first request.
+//! Every connection may send any number of requests, which are answered in
+//! order. Waiting connections are polled by a single thread, each request is
+//! answered by a worker of a thread pool, so idle clients do not occupy a
+//! worker. Clients that stall while sending a request or receiving a response
+//! get disconnected. SIGINT and SIGTERM stop the server, close every
+//! connection and remove the socket.
+//!
+//! Only available on posix systems.
+//!
+//! @param options The options of the server.
+//! @return 0 after a regular shutdown, negative on failure.
+int RunServer(const ServerOptions& options);
+
+#endif //SDF_LWM2M_CONVERTER_SRC_SERVER_H_
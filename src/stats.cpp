@@ -0,0 +1,234 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "stats.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "main.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <ctime>
+#include <sys/resource.h>
+#endif
+
+using json = nlohmann::ordered_json;
+
+namespace {
+
+const char* StageName(Stage stage)
+{
+    switch (stage) {
+        case Stage::Load:
+            return "load";
+        case Stage::Parse:
+            return "parse";
+        case Stage::Convert:
+            return "convert";
+        case Stage::Serialize:
+            return "serialize";
+        case Stage::Write:
+            return "write";
+        case Stage::Validate:
+            return "validate";
+        case Stage::Verify:
+            return "verify";
+    }
+    return "unknown";
+}
+
+#ifdef _WIN32
+
+double FiletimeSeconds(const FILETIME& time)
+{
+    ULARGE_INTEGER value;
+    value.LowPart = time.dwLowDateTime;
+    value.HighPart = time.dwHighDateTime;
+    return static_cast<double>(value.QuadPart) * 1e-7;
+}
+
+double ThreadCpuTime()
+{
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    return FiletimeSeconds(kernel) + FiletimeSeconds(user);
+}
+
+double ProcessCpuTime()
+{
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    return FiletimeSeconds(kernel) + FiletimeSeconds(user);
+}
+
+std::uint64_t PeakRss()
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+}
+
+#else
+
+double ThreadCpuTime()
+{
+    timespec time {};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+        return 0;
+    }
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+}
+
+double ProcessCpuTime()
+{
+    timespec time {};
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) {
+        return 0;
+    }
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+}
+
+std::uint64_t PeakRss()
+{
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    // Reported in bytes on macOS and in kilobytes everywhere else
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+#endif
+
+json StageJson(const StageStats& stage_stats)
+{
+    json result;
+    result["count"] = stage_stats.count;
+    result["wallTimeSeconds"] = stage_stats.wall_time;
+    result["cpuTimeSeconds"] = stage_stats.cpu_time;
+    result["bytesRead"] = stage_stats.bytes_read;
+    result["bytesWritten"] = stage_stats.bytes_written;
+    result["peakRssBytes"] = stage_stats.peak_rss;
+    return result;
+}
+
+} // namespace
+
+void StageStats::Add(const StageStats& other)
+{
+    count += other.count;
+    wall_time += other.wall_time;
+    cpu_time += other.cpu_time;
+    bytes_read += other.bytes_read;
+    bytes_written += other.bytes_written;
+    peak_rss = std::max(peak_rss, other.peak_rss);
+}
+
+Stats::Stats() : start_(std::chrono::steady_clock::now()) {}
+
+void Stats::Record(Stage stage, const std::string& file, const StageStats& stage_stats)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_[stage].Add(stage_stats);
+    if (!file.empty()) {
+        files_[file][stage].Add(stage_stats);
+    }
+}
+
+int Stats::Save(const char* path) const
+{
+    json report;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        report["wallTimeSeconds"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        report["cpuTimeSeconds"] = ProcessCpuTime();
+        report["peakRssBytes"] = PeakRss();
+
+        json& stages = report["stages"];
+        stages = json::object();
+        for (const auto& [stage, stage_stats] : stages_) {
+            stages[StageName(stage)] = StageJson(stage_stats);
+        }
+
+        // Slow files are listed first
+        std::vector<std::pair<std::string, StageStats>> totals;
+        for (const auto& [file, file_stages] : files_) {
+            StageStats total;
+            for (const auto& [stage, stage_stats] : file_stages) {
+                total.Add(stage_stats);
+            }
+            totals.emplace_back(file, total);
+        }
+        std::stable_sort(totals.begin(), totals.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second.wall_time > rhs.second.wall_time;
+        });
+
+        json& files = report["files"];
+        files = json::array();
+        for (const auto& [file, total] : totals) {
+            json entry;
+            entry["path"] = file;
+            json total_json = StageJson(total);
+            for (const auto& [key, value] : total_json.items()) {
+                if (key != "count") {
+                    entry[key] = value;
+                }
+            }
+            json& file_stages = entry["stages"];
+            for (const auto& [stage, stage_stats] : files_.at(file)) {
+                file_stages[StageName(stage)] = StageJson(stage_stats);
+            }
+            files.push_back(std::move(entry));
+        }
+    }
+    return SaveJsonFile(path, report);
+}
+
+StageTimer::StageTimer(Stats* stats, Stage stage, std::string file)
+    : stats_(stats), stage_(stage), file_(std::move(file))
+{
+    if (stats_ != nullptr) {
+        wall_start_ = std::chrono::steady_clock::now();
+        cpu_start_ = ThreadCpuTime();
+    }
+}
+
+void StageTimer::Stop()
+{
+    if (stats_ == nullptr) {
+        return;
+    }
+    stage_stats_.count = 1;
+    stage_stats_.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start_).count();
+    stage_stats_.cpu_time = ThreadCpuTime() - cpu_start_;
+    stage_stats_.peak_rss = PeakRss();
+    stats_->Record(stage_, file_, stage_stats_);
+    stats_ = nullptr;
+}
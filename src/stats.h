@@ -0,0 +1,120 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Timing and memory instrumentation of the conversion stages.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_SRC_STATS_H_
+#define SDF_LWM2M_CONVERTER_SRC_STATS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+//! Stages of the conversion of a file
+enum class Stage {
+    Load,
+    Parse,
+    Convert,
+    Serialize,
+    Write,
+    Validate,
+    //! Comparison of a round-tripped file with its original
+    Verify
+};
+
+//! Measurements of a stage
+struct StageStats {
+    std::size_t count = 0;
+    double wall_time = 0;
+    double cpu_time = 0;
+    std::uint64_t bytes_read = 0;
+    std::uint64_t bytes_written = 0;
+    //! Peak resident set size of the process at the end of the stage
+    std::uint64_t peak_rss = 0;
+
+    void Add(const StageStats& other);
+};
+
+//! @brief Collects the measurements of every stage for every file.
+//!
+//! Measurements can be recorded from multiple threads at the same time.
+//! The CPU time is the time of the recording thread, so conversions running
+//! in parallel are attributed to the right file.
+class Stats {
+public:
+    Stats();
+
+    //! @brief Record a measurement.
+    //!
+    //! @param stage The measured stage.
+    //! @param file The file the stage belongs to, empty if it does not belong to a file.
+    //! @param stage_stats The measurement.
+    void Record(Stage stage, const std::string& file, const StageStats& stage_stats);
+
+    //! @brief Save the report as json.
+    //!
+    //! The report contains the totals of the process, the totals of every stage
+    //! and the measurements of every file ordered by their wall time, slowest first.
+    //!
+    //! @param path The path to the report.
+    //! @return 0 on success, negative on failure.
+    int Save(const char* path) const;
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::map<Stage, StageStats> stages_;
+    std::map<std::string, std::map<Stage, StageStats>> files_;
+};
+
+//! @brief Measures a single stage until it is stopped or destroyed.
+//!
+//! A timer without Stats does nothing, so the instrumentation can stay in
+//! place when no report was requested.
+class StageTimer {
+public:
+    StageTimer(Stats* stats, Stage stage, std::string file = {});
+    ~StageTimer() { Stop(); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    void AddBytesRead(std::uint64_t bytes) { stage_stats_.bytes_read += bytes; }
+    void AddBytesWritten(std::uint64_t bytes) { stage_stats_.bytes_written += bytes; }
+
+    //! @brief Finish the measurement and record it, further calls do nothing.
+    void Stop();
+
+private:
+    Stats* stats_;
+    Stage stage_;
+    std::string file_;
+    std::chrono::steady_clock::time_point wall_start_;
+    double cpu_start_ = 0;
+    StageStats stage_stats_;
+};
+
+#endif //SDF_LWM2M_CONVERTER_SRC_STATS_H_
@@ -0,0 +1,220 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <converter.h>
+#include <json_diff.h>
+#include <lwm2m_stream.h>
+#include <lwm2m_tokens.h>
+#include <thread_pool.h>
+#include <xml_files.h>
+#include "main.h"
+#include "stats.h"
+#include "verify.h"
+
+using json = nlohmann::ordered_json;
+namespace fs = std::filesystem;
+
+namespace {
+
+//! Outcome of the verification of a single file
+struct VerifyResult {
+    int status = 0;
+    std::string message;
+    JsonDiff lwm2m_diff;
+    JsonDiff sdf_diff;
+};
+
+//! Function used to collect the files to verify in a stable order
+std::vector<fs::path> CollectInputFiles(const fs::path& input)
+{
+    if (!fs::is_directory(input)) {
+        return {input};
+    }
+    return CollectXmlFiles(input);
+}
+
+//! Function used to build a comparable tree of lwm2m objects, named like the elements of the xml
+json ObjectsToJson(const std::vector<lwm2m::Object>& objects)
+{
+    json tree = json::object();
+    for (const auto& object : objects) {
+        json& object_json = tree[std::to_string(object.object_id)];
+        object_json["Name"] = object.name;
+        object_json["Description1"] = object.description_1;
+        object_json["ObjectID"] = object.object_id;
+        object_json["ObjectURN"] = object.object_urn;
+        object_json["LWM2MVersion"] = object.lwm2m_version;
+        object_json["ObjectVersion"] = object.object_version;
+        object_json["MultipleInstances"] = object.multiple_instances;
+        object_json["Mandatory"] = object.mandatory;
+        object_json["ObjectType"] = object.object_type;
+        object_json["Description2"] = object.description_2;
+        json& resources = object_json["Resources"];
+        resources = json::object();
+        for (const auto& [id, resource] : object.resources) {
+            json& item = resources[std::to_string(id)];
+            item["Name"] = resource.name;
+            item["Operations"] = lwm2m::EncodeOperations(resource.operations);
+            item["MultipleInstances"] = resource.multiple_instances;
+            item["Mandatory"] = resource.mandatory;
+            item["Type"] = lwm2m::EncodeType(resource.type);
+            item["RangeEnumeration"] = resource.range_enumeration;
+            item["Units"] = resource.units;
+            item["Description"] = resource.description;
+        }
+    }
+    return tree;
+}
+
+//! Function used to convert a single object xml LwM2M -> SDF -> LwM2M -> SDF and to compare both ends
+VerifyResult VerifyFile(const fs::path& input, const VerifyOptions& options)
+{
+    const std::string input_path = input.string();
+    StageTimer parse_timer(options.stats, Stage::Parse, input_path);
+    std::ifstream lwm2m_stream(input);
+    if (!lwm2m_stream.is_open()) {
+        return Failure<VerifyResult>("Failed to load");
+    }
+    std::vector<lwm2m::Object> objects;
+    if (lwm2m::ParseObjectStream(lwm2m_stream, [&objects](lwm2m::Object&& object) {
+        objects.push_back(std::move(object));
+    }) != 0) {
+        return Failure<VerifyResult>("Failed to parse");
+    }
+    parse_timer.Stop();
+
+    // The original objects are captured before the conversion takes over their strings
+    json lwm2m_original = ObjectsToJson(objects);
+
+    StageTimer convert_timer(options.stats, Stage::Convert, input_path);
+    json sdf_model;
+    json sdf_mapping;
+    if (ConvertLwm2mToSdf(std::move(objects), sdf_model, sdf_mapping) != 0) {
+        return Failure<VerifyResult>("Failed to convert to SDF");
+    }
+    std::vector<lwm2m::Object> roundtrip_objects;
+    if (ConvertSdfToLwm2m(sdf_model, sdf_mapping, roundtrip_objects) != 0) {
+        return Failure<VerifyResult>("Failed to convert back to LwM2M");
+    }
+    json lwm2m_roundtrip = ObjectsToJson(roundtrip_objects);
+    json roundtrip_sdf_model;
+    json roundtrip_sdf_mapping;
+    if (ConvertLwm2mToSdf(std::move(roundtrip_objects), roundtrip_sdf_model, roundtrip_sdf_mapping) != 0) {
+        return Failure<VerifyResult>("Failed to convert the round-tripped LwM2M to SDF");
+    }
+    convert_timer.Stop();
+
+    // Both sdf files are compared as one tree, so the paths tell which file differs
+    json sdf_original = {{"sdfModel", std::move(sdf_model)}, {"sdfMapping", std::move(sdf_mapping)}};
+    json sdf_roundtrip = {{"sdfModel", std::move(roundtrip_sdf_model)}, {"sdfMapping", std::move(roundtrip_sdf_mapping)}};
+
+    StageTimer verify_timer(options.stats, Stage::Verify, input_path);
+    VerifyResult result;
+    result.lwm2m_diff = DiffJson(JsonMerkleTree(lwm2m_original), JsonMerkleTree(lwm2m_roundtrip), options.max_paths);
+    result.sdf_diff = DiffJson(JsonMerkleTree(sdf_original), JsonMerkleTree(sdf_roundtrip), options.max_paths);
+    return result;
+}
+
+//! Function used to add the differences of one direction to the report
+json DiffToJson(const JsonDiff& diff)
+{
+    json diff_json;
+    diff_json["count"] = diff.count;
+    diff_json["paths"] = diff.paths;
+    return diff_json;
+}
+
+} // namespace
+
+//! Function used to verify the round trip of every object xml in parallel
+int VerifyRoundtrip(const VerifyOptions& options)
+{
+    std::vector<fs::path> files;
+    try {
+        files = CollectInputFiles(options.input_path);
+    }
+    catch (const std::exception& err) {
+        std::cerr << "Failed to read directory: " << options.input_path << std::endl;
+        std::cerr << err.what() << std::endl;
+        return -1;
+    }
+
+    // Every worker only writes into the result slot of its own file
+    std::vector<VerifyResult> results(files.size());
+    {
+        ThreadPool pool(options.jobs);
+        std::cout << "Verifying " << files.size() << " Cluster XML using " << pool.Size() << " threads" << std::endl;
+        for (std::size_t i = 0; i < files.size(); i++) {
+            pool.Submit([&files, &results, &options, i] {
+                try {
+                    results[i] = VerifyFile(files[i], options);
+                }
+                catch (const std::exception& err) {
+                    results[i] = Failure<VerifyResult>(err.what());
+                }
+            });
+        }
+        pool.Wait();
+    }
+
+    // The report is assembled in path order so it is independent of the scheduling
+    bool is_directory = fs::is_directory(options.input_path);
+    std::size_t failed = 0;
+    std::size_t differing = 0;
+    json differences = json::object();
+    json failures = json::object();
+    for (std::size_t i = 0; i < files.size(); i++) {
+        std::string name = is_directory ? files[i].lexically_relative(options.input_path).generic_string()
+                                        : files[i].filename().string();
+        const VerifyResult& result = results[i];
+        if (result.status != 0) {
+            std::cerr << files[i].string() << ": " << result.message << std::endl;
+            failures[name] = result.message;
+            failed++;
+            continue;
+        }
+        if (result.lwm2m_diff.count == 0 and result.sdf_diff.count == 0) {
+            continue;
+        }
+        differing++;
+        json& file_differences = differences[name];
+        file_differences["lwm2m"] = DiffToJson(result.lwm2m_diff);
+        file_differences["sdf"] = DiffToJson(result.sdf_diff);
+    }
+
+    json report;
+    report["converterVersion"] = kConverterVersion;
+    report["files"] = files.size();
+    report["identical"] = files.size() - differing - failed;
+    report["differing"] = differing;
+    report["failed"] = failed;
+    report["differences"] = std::move(differences);
+    report["failures"] = std::move(failures);
+    if (SaveJsonFile(options.report_path.c_str(), report) != 0) {
+        std::cerr << "Failed to save the verification report" << std::endl;
+        return -1;
+    }
+
+    std::cout << files.size() - differing - failed << " of " << files.size()
+              << " Cluster XML survived the round trip unchanged!" << std::endl;
+    return differing == 0 and failed == 0 ? 0 : -1;
+}
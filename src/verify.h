@@ -0,0 +1,62 @@
+/**
+ *  Copyright 2024 Niklas Meyer
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file
+ * @author Niklas Meyer <nik_mey@uni-bremen.de>
+ *
+ * @section Description
+ *
+ * Functions to verify that lwm2m objects survive the conversion to sdf and back.
+ */
+
+#ifndef SDF_LWM2M_CONVERTER_SRC_VERIFY_H_
+#define SDF_LWM2M_CONVERTER_SRC_VERIFY_H_
+
+#include <cstddef>
+#include <string>
+#include "stats.h"
+
+//! Options for the round-trip verification of lwm2m objects
+struct VerifyOptions {
+    //! Cluster XML or directory which gets searched recursively for object xml files
+    std::string input_path;
+    //! Path to the json report
+    std::string report_path;
+    //! Number of worker threads, 0 selects the hardware concurrency
+    std::size_t jobs = 0;
+    //! Maximum number of differing paths listed per file and direction
+    std::size_t max_paths = 100;
+    //! Receives the measurements of every stage of every file, nullptr if nothing should be measured
+    Stats* stats = nullptr;
+};
+
+//! @brief Verify the round trip of every lwm2m object xml.
+//!
+//! Every file is converted LwM2M -> SDF -> LwM2M -> SDF by a pool of worker
+//! threads. The original objects are compared with the round-tripped ones
+//! and the first sdf-model and sdf-mapping with the second ones. Both
+//! comparisons use subtree hashes, so only the parts that differ are looked
+//! at and only their paths are reported.
+//!
+//! The report lists the number of verified, identical, differing and failed
+//! files and the differing paths of every file in path order.
+//!
+//! @param options The options of the verification.
+//! @return 0 if every file survived the round trip, negative otherwise.
+int VerifyRoundtrip(const VerifyOptions& options);
+
+#endif //SDF_LWM2M_CONVERTER_SRC_VERIFY_H_